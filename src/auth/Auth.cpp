@@ -87,7 +87,7 @@ void CAuth::enqueueUnlock() {
 static void passwordFailCallback(std::shared_ptr<CTimer> self, void* data) {
     g_pAuth->m_bDisplayFailText = true;
 
-    g_pMpvlock->enqueueForceUpdateTimers();  // Updated from g_pHyprlock
+    g_pMpvlock->enqueueForceUpdateTimers(FORCE_UPDATE_AUTH);  // Updated from g_pHyprlock
 
     g_pMpvlock->renderAllOutputs();  // Updated from g_pHyprlock
 }
@@ -151,7 +151,7 @@ bool CFingerprint::createDeviceProxy() {
                 if (!isPresent)
                     return;
                 m_sPrompt = m_sFingerprintPresent;
-                g_pMpvlock->enqueueForceUpdateTimers();  // Updated from g_pHyprlock
+                g_pMpvlock->enqueueForceUpdateTimers(FORCE_UPDATE_AUTH);  // Updated from g_pHyprlock
             } catch (std::out_of_range& e) {}
         });
 
@@ -251,7 +251,7 @@ void CFingerprint::startVerify(bool isRetry) {
             } else
                 m_sPrompt = m_sFingerprintReady;
         }
-        g_pMpvlock->enqueueForceUpdateTimers();  // Updated from g_pHyprlock
+        g_pMpvlock->enqueueForceUpdateTimers(FORCE_UPDATE_AUTH);  // Updated from g_pHyprlock
     });
 }
 
@@ -28,7 +28,7 @@ int conv(int num_msg, const struct pam_message** msg, struct pam_response** resp
                 Debug::log(LOG, "PAM_PROMPT: {}", PROMPT);
 
                 if (PROMPTCHANGED)
-                    g_pMpvlock->enqueueForceUpdateTimers();  // Updated from g_pHyprlock
+                    g_pMpvlock->enqueueForceUpdateTimers(FORCE_UPDATE_AUTH);  // Updated from g_pHyprlock
 
                 // Some pam configurations ask for the password twice for whatever reason (Fedora su for example)
                 // When the prompt is the same as the last one, I guess our answer can be the same.
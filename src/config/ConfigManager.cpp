@@ -213,16 +213,19 @@ void CConfigManager::init() {
         m_config.addSpecialConfigValue(name, "shadow_size", Hyprlang::INT{3});                                                                                                         \
         m_config.addSpecialConfigValue(name, "shadow_passes", Hyprlang::INT{0});                                                                                                       \
         m_config.addSpecialConfigValue(name, "shadow_color", Hyprlang::INT{0xFF000000});                                                                                               \
-        m_config.addSpecialConfigValue(name, "shadow_boost", Hyprlang::FLOAT{1.2});
+        m_config.addSpecialConfigValue(name, "shadow_boost", Hyprlang::FLOAT{1.2});                                                                                                    \
+        m_config.addSpecialConfigValue(name, "shadow_blur_scale", Hyprlang::FLOAT{1.0});
 
     m_config.addConfigValue("general:text_trim", Hyprlang::INT{1});
     m_config.addConfigValue("general:hide_cursor", Hyprlang::INT{0});
     m_config.addConfigValue("general:grace", Hyprlang::INT{0});
+    m_config.addConfigValue("general:grace_includes_suspend", Hyprlang::INT{0});
     m_config.addConfigValue("general:ignore_empty_input", Hyprlang::INT{0});
     m_config.addConfigValue("general:immediate_render", Hyprlang::INT{0});
     m_config.addConfigValue("general:fractional_scaling", Hyprlang::INT{2});
     m_config.addConfigValue("general:screencopy_mode", Hyprlang::INT{0});
     m_config.addConfigValue("general:fail_timeout", Hyprlang::INT{2000});
+    m_config.addConfigValue("general:min_filter", Hyprlang::STRING{"linear"});
 
     m_config.addConfigValue("auth:pam:enabled", Hyprlang::INT{1});
     m_config.addConfigValue("auth:pam:module", Hyprlang::STRING{"mpvlock"});
@@ -240,6 +243,7 @@ void CConfigManager::init() {
     m_config.addSpecialConfigValue("background", "color", Hyprlang::INT{0xFF111111});
     m_config.addSpecialConfigValue("background", "blur_size", Hyprlang::INT{8});
     m_config.addSpecialConfigValue("background", "blur_passes", Hyprlang::INT{0});
+    m_config.addSpecialConfigValue("background", "blur_scale", Hyprlang::FLOAT{1.0});
     m_config.addSpecialConfigValue("background", "noise", Hyprlang::FLOAT{0.0117});
     m_config.addSpecialConfigValue("background", "contrast", Hyprlang::FLOAT{0.8917});
     m_config.addSpecialConfigValue("background", "brightness", Hyprlang::FLOAT{0.8172});
@@ -269,6 +273,7 @@ void CConfigManager::init() {
     m_config.addSpecialConfigValue("shape", "valign", Hyprlang::STRING{"center"});
     m_config.addSpecialConfigValue("shape", "rotate", Hyprlang::FLOAT{0});
     m_config.addSpecialConfigValue("shape", "xray", Hyprlang::INT{0});
+    m_config.addSpecialConfigValue("shape", "blur_scale", Hyprlang::FLOAT{1.0});
     m_config.addSpecialConfigValue("shape", "zindex", Hyprlang::INT{0});
     m_config.addSpecialConfigValue("shape", "fade", Hyprlang::INT{0});
     m_config.addSpecialConfigValue("shape", "fade_duration", Hyprlang::INT{1000});
@@ -366,10 +371,12 @@ void CConfigManager::init() {
     // fade
     m_AnimationTree.createNode("fadeIn", "fade");
     m_AnimationTree.createNode("fadeOut", "fade");
+    m_AnimationTree.createNode("widgetFade", "fade");
 
     // set config for root node
     m_AnimationTree.setConfigForNode("global", 1, 8.f, "default");
     m_AnimationTree.setConfigForNode("inputFieldColors", 1, 8.f, "linear");
+    m_AnimationTree.setConfigForNode("widgetFade", 1, 10.f, "linear");
 
     m_config.commence();
 
@@ -386,8 +393,8 @@ std::vector<CConfigManager::SWidgetConfig> CConfigManager::getWidgetConfigs() {
 
     #define SHADOWABLE(name)                                                                                                                                                           \
         {"shadow_size", m_config.getSpecialConfigValue(name, "shadow_size", k.c_str())}, {"shadow_passes", m_config.getSpecialConfigValue(name, "shadow_passes", k.c_str())},          \
-            {"shadow_color", m_config.getSpecialConfigValue(name, "shadow_color", k.c_str())}, {                                                                                       \
-            "shadow_boost", m_config.getSpecialConfigValue(name, "shadow_boost", k.c_str())                                                                                            \
+            {"shadow_color", m_config.getSpecialConfigValue(name, "shadow_color", k.c_str())}, {"shadow_boost", m_config.getSpecialConfigValue(name, "shadow_boost", k.c_str())}, {    \
+            "shadow_blur_scale", m_config.getSpecialConfigValue(name, "shadow_blur_scale", k.c_str())                                                                                  \
         }
 
     //
@@ -404,6 +411,7 @@ std::vector<CConfigManager::SWidgetConfig> CConfigManager::getWidgetConfigs() {
                 {"color", m_config.getSpecialConfigValue("background", "color", k.c_str())},
                 {"blur_size", m_config.getSpecialConfigValue("background", "blur_size", k.c_str())},
                 {"blur_passes", m_config.getSpecialConfigValue("background", "blur_passes", k.c_str())},
+                {"blur_scale", m_config.getSpecialConfigValue("background", "blur_scale", k.c_str())},
                 {"noise", m_config.getSpecialConfigValue("background", "noise", k.c_str())},
                 {"contrast", m_config.getSpecialConfigValue("background", "contrast", k.c_str())},
                 {"vibrancy", m_config.getSpecialConfigValue("background", "vibrancy", k.c_str())},
@@ -444,6 +452,7 @@ std::vector<CConfigManager::SWidgetConfig> CConfigManager::getWidgetConfigs() {
                 {"valign", m_config.getSpecialConfigValue("shape", "valign", k.c_str())},
                 {"rotate", m_config.getSpecialConfigValue("shape", "rotate", k.c_str())},
                 {"xray", m_config.getSpecialConfigValue("shape", "xray", k.c_str())},
+                {"blur_scale", m_config.getSpecialConfigValue("shape", "blur_scale", k.c_str())},
                 {"zindex", m_config.getSpecialConfigValue("shape", "zindex", k.c_str())},
                 {"fade", m_config.getSpecialConfigValue("shape", "fade", k.c_str())},
                 {"fade_duration", m_config.getSpecialConfigValue("shape", "fade_duration", k.c_str())},
@@ -2,6 +2,7 @@
 #include "../helpers/AnimatedVariable.hpp"
 #include "../config/ConfigDataValues.hpp"
 #include "../config/ConfigManager.hpp"
+#include <algorithm>
 
 CMpvlockAnimationManager::CMpvlockAnimationManager() {  // Updated from CHyprlockAnimationManager
     addBezierWithName("linear", {0, 0}, {1, 1});
@@ -118,6 +119,20 @@ void CMpvlockAnimationManager::tick() {  // Updated from CHyprlockAnimationManag
     tickDone();
 }
 
+SP<CMpvlockAnimationManager::SAnimationPropertyConfig> CMpvlockAnimationManager::makeTimedConfig(const std::string& node, uint64_t durationMs) {
+    const auto NODECONFIG = g_pConfigManager->m_AnimationTree.getConfig(node);
+    const auto VALUES     = NODECONFIG->pValues.lock();
+
+    auto       config     = makeShared<SAnimationPropertyConfig>(*VALUES);
+
+    config->overridden       = true;
+    config->internalSpeed    = std::max(durationMs, (uint64_t)1) / 100.f; // speed is in ds
+    config->pValues          = config;
+    config->pParentAnimation = NODECONFIG;
+
+    return config;
+}
+
 void CMpvlockAnimationManager::scheduleTick() {  // Updated from CHyprlockAnimationManager
     m_bTickScheduled = true;
 }
@@ -27,7 +27,11 @@ class CMpvlockAnimationManager : public Hyprutils::Animation::CAnimationManager
         pav = std::move(PAV);
     }
 
-    bool m_bTickScheduled = false;
+    // A copy of the node's config that runs for a fixed duration instead of the node's speed.
+    // Used where the duration is a widget option (e.g. fade_duration). The returned config has to be kept alive by the caller.
+    SP<SAnimationPropertyConfig> makeTimedConfig(const std::string& node, uint64_t durationMs);
+
+    bool                         m_bTickScheduled = false;
 };
 
 inline UP<CMpvlockAnimationManager> g_pAnimationManager;
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "Clock.hpp"
+#include "../helpers/Log.hpp"
+#include <array>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+constexpr time_t CLOCKSET_HORIZON_SECS = 365 * 24 * 60 * 60;
+// wakes a hair after the minute flips, so the label never formats the minute it just left
+constexpr auto   MINUTE_WAKEUP_SLACK   = std::chrono::milliseconds(5);
+
+enum eClockSource : uint64_t {
+    CLOCK_SOURCE_TIMEZONE = 0,
+    CLOCK_SOURCE_CLOCKSET,
+};
+
+CClock::CClock() {
+    m_iEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_iEpollFd < 0) {
+        Debug::log(WARN, "Clock: can't create an epoll instance, time changes won't be picked up: {}", strerror(errno));
+        return;
+    }
+
+    // /etc/localtime is usually a symlink that gets replaced, so watch the directory for its name
+    m_iInotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (m_iInotifyFd >= 0 && inotify_add_watch(m_iInotifyFd, "/etc", IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB) < 0) {
+        close(m_iInotifyFd);
+        m_iInotifyFd = -1;
+    }
+
+    if (m_iInotifyFd >= 0) {
+        epoll_event ev = {.events = EPOLLIN, .data = {.u64 = CLOCK_SOURCE_TIMEZONE}};
+        epoll_ctl(m_iEpollFd, EPOLL_CTL_ADD, m_iInotifyFd, &ev);
+    } else
+        Debug::log(WARN, "Clock: can't watch /etc, timezone changes won't be picked up: {}", strerror(errno));
+
+    // monotonic timers stand still during suspend, this is what tells us the wall clock moved on
+    m_iClockSetFd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (m_iClockSetFd >= 0) {
+        armClockSetFd();
+        epoll_event ev = {.events = EPOLLIN, .data = {.u64 = CLOCK_SOURCE_CLOCKSET}};
+        epoll_ctl(m_iEpollFd, EPOLL_CTL_ADD, m_iClockSetFd, &ev);
+    } else
+        Debug::log(WARN, "Clock: can't create a realtime timerfd, clock changes won't be picked up: {}", strerror(errno));
+}
+
+CClock::~CClock() {
+    for (const auto fd : {m_iEpollFd, m_iInotifyFd, m_iClockSetFd}) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+void CClock::armClockSetFd() {
+    // far enough out to never matter, it is armed again should it ever expire
+    itimerspec spec = {.it_interval = {}, .it_value = {.tv_sec = time(nullptr) + CLOCKSET_HORIZON_SECS, .tv_nsec = 0}};
+    if (timerfd_settime(m_iClockSetFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) != 0)
+        Debug::log(WARN, "Clock: failed to arm the realtime timerfd: {}", strerror(errno));
+}
+
+int CClock::fd() const {
+    return m_iInotifyFd >= 0 || m_iClockSetFd >= 0 ? m_iEpollFd : -1;
+}
+
+bool CClock::onFdReadable() {
+    std::array<epoll_event, 2> events;
+    const int                  NEVENTS = epoll_wait(m_iEpollFd, events.data(), events.size(), 0);
+
+    bool                       zoneChanged  = false;
+    bool                       clockChanged = false;
+
+    for (int i = 0; i < NEVENTS; ++i) {
+        if (events[i].data.u64 == CLOCK_SOURCE_CLOCKSET) {
+            uint64_t expirations = 0;
+            // fails with ECANCELED once the clock was set, either way it has to be armed again
+            clockChanged = read(m_iClockSetFd, &expirations, sizeof(expirations)) < 0 && errno == ECANCELED;
+            armClockSetFd();
+            continue;
+        }
+
+        alignas(inotify_event) char buf[4096];
+        ssize_t                     len = 0;
+        while ((len = read(m_iInotifyFd, buf, sizeof(buf))) > 0) {
+            for (char* ptr = buf; ptr < buf + len;) {
+                const auto* EVENT = (const inotify_event*)ptr;
+                if (EVENT->len > 0 && std::strcmp(EVENT->name, "localtime") == 0)
+                    zoneChanged = true;
+                ptr += sizeof(inotify_event) + EVENT->len;
+            }
+        }
+    }
+
+    if (zoneChanged) {
+        Debug::log(LOG, "Clock: /etc/localtime changed, resolving the timezone again");
+        m_bZoneResolved = false;
+        m_pZone         = nullptr;
+    }
+
+    if (clockChanged)
+        Debug::log(LOG, "Clock: the wall clock jumped");
+
+    return zoneChanged || clockChanged;
+}
+
+std::chrono::system_clock::duration CClock::localSinceEpoch() {
+    if (!m_bZoneResolved) {
+        m_bZoneResolved = true;
+        m_pZone         = nullptr;
+
+        try {
+            auto name = std::getenv("TZ");
+            if (name)
+                m_pZone = std::chrono::locate_zone(name);
+        } catch (std::runtime_error&) { Debug::log(WARN, "Invalid TZ value. Falling back to current timezone!"); }
+
+        try {
+            if (!m_pZone)
+                m_pZone = std::chrono::current_zone();
+        } catch (std::runtime_error&) {}
+    }
+
+    const auto TPNOW = std::chrono::system_clock::now();
+
+    if (!m_pZone) {
+        if (!m_bLoggedNoZone) {
+            Debug::log(WARN, "Current timezone unknown. Falling back to UTC!");
+            m_bLoggedNoZone = true;
+        }
+        return TPNOW.time_since_epoch();
+    }
+
+    return m_pZone->to_local(TPNOW).time_since_epoch();
+}
+
+std::chrono::hh_mm_ss<std::chrono::system_clock::duration> CClock::timeOfDay() {
+    const auto LOCAL = localSinceEpoch();
+    return std::chrono::hh_mm_ss{LOCAL - std::chrono::floor<std::chrono::days>(LOCAL)};
+}
+
+std::chrono::steady_clock::duration CClock::untilNextMinute() {
+    const auto LOCAL = localSinceEpoch();
+    const auto NEXT  = std::chrono::floor<std::chrono::minutes>(LOCAL) + std::chrono::minutes(1);
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(NEXT - LOCAL + MINUTE_WAKEUP_SLACK);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../defines.hpp"
+#include <chrono>
+
+#if defined(_LIBCPP_VERSION) && _LIBCPP_VERSION < 190100
+#pragma comment(lib, "date-tz")
+#include <date/tz.h>
+namespace std {
+    namespace chrono {
+        using date::current_zone;
+        using date::locate_zone;
+        using date::time_zone;
+    }
+}
+#endif
+
+// Local wall-clock time for $TIME and friends. The zone is resolved once and again only when
+// /etc/localtime changes. That, and the wall clock jumping (set by hand, resume from suspend),
+// is what the event loop learns through fd(), so minute-aligned timers can be planted again.
+class CClock {
+  public:
+    CClock();
+    ~CClock();
+
+    std::chrono::hh_mm_ss<std::chrono::system_clock::duration> timeOfDay();
+    // until the local wall clock shows the next minute, for labels that only show minutes
+    std::chrono::steady_clock::duration                        untilNextMinute();
+
+    // readable when the timezone or the wall clock might have changed, -1 if neither can be watched
+    int                                                        fd() const;
+    // drains fd(), true if local time jumped and what shows it should update now
+    bool                                                       onFdReadable();
+
+  private:
+    // local time as a duration since the epoch, what to_local yields without naming local_time
+    std::chrono::system_clock::duration                        localSinceEpoch();
+    void                                                       armClockSetFd();
+
+    const std::chrono::time_zone*                              m_pZone         = nullptr;
+    bool                                                       m_bZoneResolved = false;
+    bool                                                       m_bLoggedNoZone = false;
+    int                                                        m_iEpollFd      = -1;
+    int                                                        m_iInotifyFd    = -1;
+    // CLOCK_REALTIME timerfd that never expires, it is cancelled whenever the clock is set
+    int                                                        m_iClockSetFd   = -1;
+};
+
+inline UP<CClock> g_pClock;
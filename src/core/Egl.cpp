@@ -50,6 +50,20 @@ CEGL::CEGL(wl_display* display) {
         goto error;
     }
 
+    if (const char* _DPYEXTS = eglQueryString(eglDisplay, EGL_EXTENSIONS); _DPYEXTS) {
+        const std::string DPYEXTS = _DPYEXTS;
+
+        if (DPYEXTS.contains("EGL_KHR_swap_buffers_with_damage"))
+            eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+        else if (DPYEXTS.contains("EGL_EXT_swap_buffers_with_damage"))
+            eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+
+        m_bHasBufferAge = DPYEXTS.contains("EGL_EXT_buffer_age");
+    }
+
+    if (!eglSwapBuffersWithDamage || !m_bHasBufferAge)
+        Debug::log(LOG, "EGL is missing swap_buffers_with_damage or buffer_age, every frame will be a full redraw");
+
     if (!eglChooseConfig(eglDisplay, config_attribs, &eglConfig, 1, &matched)) {
         Debug::log(CRIT, "eglChooseConfig failed");
         goto error;
@@ -15,6 +15,10 @@ class CEGL {
     EGLContext                               eglContext;
 
     PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC eglCreatePlatformWindowSurfaceEXT;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC       eglSwapBuffersWithDamage = nullptr;
+
+    // EGL_EXT_buffer_age, lets us repaint only what changed since the back buffer was last presented
+    bool                                     m_bHasBufferAge = false;
 
     void                                     makeCurrent(EGLSurface surf);
 };
@@ -7,6 +7,8 @@
 #include "../renderer/Renderer.hpp"
 
 CSessionLockSurface::~CSessionLockSurface() {
+    Debug::log(LOG, "Lock surface rendered {} frames for {} render requests ({} coalesced)", m_frames, m_renderRequests, m_renderCoalesced);
+
     if (eglWindow)
         wl_egl_window_destroy(eglWindow);
 }
@@ -74,7 +76,7 @@ void CSessionLockSurface::configure(const Vector2D& size_, uint32_t serial_) {
 
     Debug::log(LOG, "Configuring surface for logical {} and pixel {}", logicalSize, size);
 
-    surface->sendDamageBuffer(0, 0, 0xFFFF, 0xFFFF);
+    damageEntire();
 
     if (!eglWindow) {
         eglWindow = wl_egl_window_create((wl_surface*)surface->resource(), size.x, size.y);
@@ -85,6 +87,13 @@ void CSessionLockSurface::configure(const Vector2D& size_, uint32_t serial_) {
     if (!eglSurface) {
         eglSurface = g_pEGL->eglCreatePlatformWindowSurfaceEXT(g_pEGL->eglDisplay, g_pEGL->eglConfig, eglWindow, nullptr);
         RASSERT(eglSurface, "Couldn't create eglSurface");
+
+        // We only render after this surface's frame callback, so EGL throttling on top of that buys nothing.
+        // Worse, with the default interval of 1 a swap on one output can block until the compositor presents it,
+        // holding back every other output that renders after it in the same loop iteration.
+        g_pEGL->makeCurrent(eglSurface);
+        if (eglSwapInterval(g_pEGL->eglDisplay, 0) != EGL_TRUE)
+            Debug::log(WARN, "Couldn't disable the swap interval for {}, a slow output may delay the others", POUTPUT->stringPort);
     }
 
     if (readyForFrame && !(SAMESIZE && SAMESCALE)) {
@@ -107,16 +116,19 @@ void CSessionLockSurface::render() {
         return;
     }
 
+    m_bRenderPending = false;
+
     g_pAnimationManager->tick();
-    const auto FEEDBACK = g_pRenderer->renderLock(*this);
-    frameCallback       = makeShared<CCWlCallback>(surface->sendFrame());
+    auto FEEDBACK = g_pRenderer->renderLock(*this);
+    frameCallback = makeShared<CCWlCallback>(surface->sendFrame());
     frameCallback->setDone([this](CCWlCallback* r, uint32_t frameTime) {
         if (g_pMpvlock->m_bTerminate)  // Updated from g_pHyprlock
             return;
 
         if (Debug::verbose) {
             const auto POUTPUT = m_outputRef.lock();
-            Debug::log(TRACE, "[{}] frame {}, Current fps: {:.2f}", POUTPUT->stringPort, m_frames, 1000.f / (frameTime - m_lastFrameTime));
+            Debug::log(TRACE, "[{}] frame {}, Current fps: {:.2f}, render requests: {} ({} coalesced)", POUTPUT->stringPort, m_frames, 1000.f / (frameTime - m_lastFrameTime),
+                       m_renderRequests, m_renderCoalesced);
         }
 
         m_lastFrameTime = frameTime;
@@ -126,11 +138,49 @@ void CSessionLockSurface::render() {
         onCallback();
     });
 
-    eglSwapBuffers(g_pEGL->eglDisplay, eglSurface);
+    if (g_pEGL->eglSwapBuffersWithDamage) {
+        // GL and damage rects share the bottom-left origin. An empty rect keeps the frame callback
+        // going without damaging anything, zero rects would mean "everything" to EGL.
+        std::vector<EGLint> rects;
+        for (const auto& r : FEEDBACK.damage.getRects()) {
+            rects.insert(rects.end(), {r.x1, r.y1, r.x2 - r.x1, r.y2 - r.y1});
+        }
+
+        if (rects.empty())
+            rects = {0, 0, 0, 0};
+
+        g_pEGL->eglSwapBuffersWithDamage(g_pEGL->eglDisplay, eglSurface, rects.data(), rects.size() / 4);
+    } else
+        eglSwapBuffers(g_pEGL->eglDisplay, eglSurface);
 
     needsFrame = FEEDBACK.needsFrame || g_pAnimationManager->shouldTickForNext();
 }
 
+void CSessionLockSurface::scheduleRender() {
+    m_renderRequests++;
+    if (m_bRenderPending)
+        m_renderCoalesced++;
+
+    m_bRenderPending = true;
+    needsFrame       = true;
+}
+
+void CSessionLockSurface::renderIfScheduled() {
+    if (!needsFrame || frameCallback || !readyForFrame || g_pMpvlock->m_bTerminate)
+        return;
+
+    needsFrame = false;
+    render();
+}
+
+void CSessionLockSurface::damage(const CBox& box) {
+    m_damage.add(box);
+}
+
+void CSessionLockSurface::damageEntire() {
+    m_bFullDamage = true;
+}
+
 void CSessionLockSurface::onCallback() {
     frameCallback.reset();
 
@@ -6,8 +6,10 @@
 #include "viewporter.hpp"
 #include "fractional-scale-v1.hpp"
 #include "../helpers/Math.hpp"
+#include <hyprutils/math/Region.hpp>
 #include <wayland-egl.h>
 #include <EGL/egl.h>
+#include <array>
 
 class COutput;
 class CRenderer;
@@ -24,9 +26,17 @@ class CSessionLockSurface {
     float fractionalScale = 1.0;
 
     void  render();
+    // marks the surface dirty. It's rendered once on the next loop iteration or frame callback, however often this is called until then.
+    void  scheduleRender();
+    // renders if scheduled and the compositor is ready for another frame
+    void  renderIfScheduled();
     void  onCallback();
     void  onScaleUpdate();
 
+    // schedule a repaint of (part of) the surface, in surface pixels
+    void  damage(const CBox& box);
+    void  damageEntire();
+
   private:
     WP<COutput>                   m_outputRef;
     OUTPUTID                      m_outputID = OUTPUT_INVALID;
@@ -44,9 +54,22 @@ class CSessionLockSurface {
 
     bool                          needsFrame = false;
 
+    // damage not yet painted and whether the next frame must repaint everything
+    CRegion                       m_damage;
+    bool                          m_bFullDamage = true;
+    // damage of the last frames, newest first. Combined with the buffer age it tells us
+    // what's stale in the back buffer we're about to render into
+    std::array<CRegion, 3>        m_damageHistory;
+
     uint32_t                      m_lastFrameTime = 0;
     uint32_t                      m_frames        = 0;
 
+    // scheduleRender() calls, and how many of those were folded into an already scheduled render
+    uint64_t                      m_renderRequests  = 0;
+    uint64_t                      m_renderCoalesced = 0;
+    // a scheduleRender() not served by a render yet. Unlike needsFrame, frames asked for by animations don't set it
+    bool                          m_bRenderPending  = false;
+
     // wayland callbacks
     SP<CCWlCallback> frameCallback = nullptr;
 
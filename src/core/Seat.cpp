@@ -27,7 +27,7 @@ void CSeatManager::registerSeat(SP<CCWlSeat> seat) {
             m_pPointer = makeShared<CCWlPointer>(r->sendGetPointer());
 
             m_pPointer->setMotion([](CCWlPointer* r, uint32_t time, wl_fixed_t surface_x, wl_fixed_t surface_y) {
-                if (std::chrono::system_clock::now() > g_pMpvlock->m_tGraceEnds)  // Updated from g_pHyprlock
+                if (!g_pMpvlock->isInGrace())  // Updated from g_pHyprlock
                     return;
 
                 if (!g_pMpvlock->isUnlocked() && g_pMpvlock->m_vLastEnterCoords.distance({wl_fixed_to_double(surface_x), wl_fixed_to_double(surface_y)}) > 5) {  // Updated from g_pHyprlock
@@ -107,12 +107,7 @@ void CSeatManager::registerSeat(SP<CCWlSeat> seat) {
 
                 if (group != g_pMpvlock->m_uiActiveLayout) {  // Updated from g_pHyprlock
                     g_pMpvlock->m_uiActiveLayout = group;  // Updated from g_pHyprlock
-                    for (auto& t : g_pMpvlock->getTimers()) {  // Updated from g_pHyprlock
-                        if (t->canForceUpdate()) {
-                            t->call(t);
-                            t->cancel();
-                        }
-                    }
+                    g_pMpvlock->forceUpdateTimers(FORCE_UPDATE_LAYOUT);
                 }
 
                 xkb_state_update_mask(m_pXKBState, mods_depressed, mods_latched, mods_locked, 0, 0, group);
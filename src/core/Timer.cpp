@@ -1,12 +1,13 @@
 #include "Timer.hpp"
 
-CTimer::CTimer(std::chrono::system_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force) :
-    cb(cb_), data(data_), allowForceUpdate(force) {
-    expires = std::chrono::system_clock::now() + timeout;
+CTimer::CTimer(std::chrono::steady_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force,
+               uint32_t forceReasons_) :
+    cb(cb_), data(data_), allowForceUpdate(force), forceReasons(forceReasons_) {
+    expires = std::chrono::steady_clock::now() + timeout;
 }
 
 bool CTimer::passed() {
-    return std::chrono::system_clock::now() > expires;
+    return std::chrono::steady_clock::now() > expires;
 }
 
 void CTimer::cancel() {
@@ -22,9 +23,14 @@ void CTimer::call(std::shared_ptr<CTimer> self) {
 }
 
 float CTimer::leftMs() {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::system_clock::now()).count();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::steady_clock::now()).count();
 }
 
-bool CTimer::canForceUpdate() {
-    return allowForceUpdate;
+std::chrono::steady_clock::time_point CTimer::expiry() const {
+    return expires;
+}
+
+bool CTimer::canForceUpdate(uint32_t reasons) {
+    // cancelled timers linger in the queue until they come up, their owner may already be gone
+    return allowForceUpdate && !wasCancelled && (forceReasons & reasons);
 }
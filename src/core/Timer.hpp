@@ -1,25 +1,37 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <functional>
 
+// what changed when timers are forced to fire early, a timer only answers to what it was planted for
+enum eForceUpdateReason : uint32_t {
+    FORCE_UPDATE_TIME   = 1 << 0,
+    FORCE_UPDATE_AUTH   = 1 << 1,
+    FORCE_UPDATE_LAYOUT = 1 << 2,
+    FORCE_UPDATE_ALL    = ~0u,
+};
+
 class CTimer {
   public:
-    CTimer(std::chrono::system_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force);
+    CTimer(std::chrono::steady_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force,
+           uint32_t forceReasons = FORCE_UPDATE_ALL);
 
-    void  cancel();
-    bool  passed();
-    bool  canForceUpdate();
+    void                                  cancel();
+    bool                                  passed();
+    bool                                  canForceUpdate(uint32_t reasons);
 
-    float leftMs();
+    float                                 leftMs();
+    std::chrono::steady_clock::time_point expiry() const;
 
-    bool  cancelled();
-    void  call(std::shared_ptr<CTimer> self);
+    bool                                  cancelled();
+    void                                  call(std::shared_ptr<CTimer> self);
 
   private:
     std::function<void(std::shared_ptr<CTimer> self, void* data)> cb;
     void*                                                         data = nullptr;
-    std::chrono::system_clock::time_point                         expires;
+    std::chrono::steady_clock::time_point                         expires;
     bool                                                          wasCancelled     = false;
     bool                                                          allowForceUpdate = false;
+    uint32_t                                                      forceReasons     = FORCE_UPDATE_ALL;
 };
@@ -5,10 +5,13 @@
 #include "../renderer/Renderer.hpp"
 #include "../auth/Auth.hpp"
 #include "../auth/Fingerprint.hpp"
+#include "Clock.hpp"
 #include "Egl.hpp"
 #include <hyprutils/memory/UniquePtr.hpp>
 #include <sys/wait.h>
-#include <sys/poll.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <csignal>
@@ -19,11 +22,17 @@
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
+#include <array>
 #include <sdbus-c++/sdbus-c++.h>
-#include <hyprutils/os/Process.hpp>
 #include <malloc.h>
+#include <poll.h>
+#include <spawn.h>
 
-using namespace Hyprutils::OS;
+static std::chrono::nanoseconds clockNow(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
 
 static void setMallocThreshold() {
 #ifdef M_TRIM_THRESHOLD
@@ -43,11 +52,14 @@ CMpvlock::CMpvlock(const std::string& wlDisplay, const bool immediate, const boo
 
     g_pEGL = makeUnique<CEGL>(m_sWaylandState.display);
 
+    static const auto GRACESUSPEND = g_pConfigManager->getValue<Hyprlang::INT>("general:grace_includes_suspend");
+    m_iGraceClock                  = *GRACESUSPEND ? CLOCK_BOOTTIME : CLOCK_MONOTONIC;
+
     if (!immediate) {
         static const auto GRACE = g_pConfigManager->getValue<Hyprlang::INT>("general:grace");
-        m_tGraceEnds            = *GRACE ? std::chrono::system_clock::now() + std::chrono::seconds(*GRACE) : std::chrono::system_clock::from_time_t(0);
+        m_tGraceEnds            = *GRACE ? clockNow(m_iGraceClock) + std::chrono::seconds(*GRACE) : std::chrono::nanoseconds{0};
     } else
-        m_tGraceEnds = std::chrono::system_clock::from_time_t(0);
+        m_tGraceEnds = std::chrono::nanoseconds{0};
 
     static const auto IMMEDIATERENDER = g_pConfigManager->getValue<Hyprlang::INT>("general:immediate_render");
     m_bImmediateRender                = immediateRender || *IMMEDIATERENDER;
@@ -55,19 +67,33 @@ CMpvlock::CMpvlock(const std::string& wlDisplay, const bool immediate, const boo
     const auto CURRENTDESKTOP = getenv("XDG_CURRENT_DESKTOP");
     const auto SZCURRENTD     = std::string{CURRENTDESKTOP ? CURRENTDESKTOP : ""};
     m_sCurrentDesktop         = SZCURRENTD;
+
+    // created early, timers can be added before the loop runs
+    m_sLoopState.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    RASSERT(m_sLoopState.timerFd >= 0, "[core] Couldn't create a timerfd: {}", strerror(errno));
 }
 
 CMpvlock::~CMpvlock() {  // Updated from CHyprlock
     if (dma.gbmDevice)
         gbm_device_destroy(dma.gbmDevice);
+
+    for (const auto fd : {m_sLoopState.epollFd, m_sLoopState.timerFd, m_sLoopState.signalFd}) {
+        if (fd >= 0)
+            close(fd);
+    }
 }
 
-static void registerSignalAction(int sig, void (*handler)(int), int sa_flags = 0) {
-    struct sigaction sa;
-    sa.sa_handler = handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = sa_flags;
-    sigaction(sig, &sa, nullptr);
+enum eLoopSource : uint64_t {
+    LOOP_WAYLAND = 0,
+    LOOP_TIMER,
+    LOOP_DBUS,
+    LOOP_SIGNAL,
+    LOOP_CLOCK,
+};
+
+static void addLoopSource(int epollFd, int fd, eLoopSource source) {
+    epoll_event ev = {.events = EPOLLIN, .data = {.u64 = source}};
+    RASSERT(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0, "[core] Couldn't add fd {} to the event loop: {}", fd, strerror(errno));
 }
 
 static void handleUnlockSignal(int sig) {
@@ -78,18 +104,8 @@ static void handleUnlockSignal(int sig) {
 }
 
 static void handleForceUpdateSignal(int sig) {
-    if (sig == SIGUSR2) {
-        for (auto& t : g_pMpvlock->getTimers()) {  // Updated from g_pHyprlock
-            if (t->canForceUpdate()) {
-                t->call(t);
-                t->cancel();
-            }
-        }
-    }
-}
-
-static void handlePollTerminate(int sig) {
-    ;
+    if (sig == SIGUSR2)
+        g_pMpvlock->forceUpdateTimers(FORCE_UPDATE_ALL);
 }
 
 static char* gbm_find_render_node(drmDevice* device) {
@@ -239,6 +255,14 @@ void CMpvlock::addDmabufListener() {  // Updated from CHyprlock
 }
 
 void CMpvlock::run() {  // Updated from CHyprlock
+    // SIGUSR1/SIGUSR2 are read from a signalfd in the event loop.
+    // Block them before any other thread is spawned, so that every thread inherits the mask and none of them gets them delivered.
+    sigset_t loopSignals;
+    sigemptyset(&loopSignals);
+    sigaddset(&loopSignals, SIGUSR1);
+    sigaddset(&loopSignals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &loopSignals, nullptr);
+
     m_sWaylandState.registry = makeShared<CCWlRegistry>((wl_proxy*)wl_display_get_registry(m_sWaylandState.display));
     m_sWaylandState.registry->setGlobal([this](CCWlRegistry* r, uint32_t name, const char* interface, uint32_t version) {
         const std::string IFACE = interface;
@@ -307,6 +331,7 @@ void CMpvlock::run() {  // Updated from CHyprlock
     // gather info about monitors
     wl_display_roundtrip(m_sWaylandState.display);
 
+    g_pClock    = makeUnique<CClock>();
     g_pRenderer = makeUnique<CRenderer>();
     g_pAuth     = makeUnique<CAuth>();
     g_pAuth->start();
@@ -314,7 +339,8 @@ void CMpvlock::run() {  // Updated from CHyprlock
     Debug::log(LOG, "Running on {}", m_sCurrentDesktop);
 
     // Hyprland violates the protocol a bit to allow for this.
-    if (m_sCurrentDesktop != "Hyprland") {
+    // With immediate_render the lock is taken right away, backgrounds show their color until their image is in.
+    if (m_sCurrentDesktop != "Hyprland" && !m_bImmediateRender) {
         while (!g_pRenderer->asyncResourceGatherer->gathered) {
             wl_display_flush(m_sWaylandState.display);
             if (wl_display_prepare_read(m_sWaylandState.display) == 0) {
@@ -329,8 +355,6 @@ void CMpvlock::run() {  // Updated from CHyprlock
 
     // Failed to lock the session
     if (!acquireSessionLock()) {
-        m_sLoopState.timerEvent = true;
-        m_sLoopState.timerCV.notify_all();
         g_pRenderer->asyncResourceGatherer->notify();
         g_pRenderer->asyncResourceGatherer->await();
         g_pAuth->terminate();
@@ -340,135 +364,105 @@ void CMpvlock::run() {  // Updated from CHyprlock
     const auto fingerprintAuth = g_pAuth->getImpl(AUTH_IMPL_FINGERPRINT);
     const auto dbusConn        = (fingerprintAuth) ? ((CFingerprint*)fingerprintAuth.get())->getConnection() : nullptr;
 
-    registerSignalAction(SIGUSR1, handleUnlockSignal, SA_RESTART);
-    registerSignalAction(SIGUSR2, handleForceUpdateSignal);
-    registerSignalAction(SIGRTMIN, handlePollTerminate);
-
-    pollfd pollfds[2];
-    pollfds[0] = {
-        .fd     = wl_display_get_fd(m_sWaylandState.display),
-        .events = POLLIN,
-    };
-    if (dbusConn) {
-        pollfds[1] = {
-            .fd     = dbusConn->getEventLoopPollData().fd,
-            .events = POLLIN,
-        };
-    }
-    size_t      fdcount = dbusConn ? 2 : 1;
+    m_sLoopState.signalFd = signalfd(-1, &loopSignals, SFD_CLOEXEC | SFD_NONBLOCK);
+    RASSERT(m_sLoopState.signalFd >= 0, "[core] Couldn't create a signalfd: {}", strerror(errno));
 
-    std::thread pollThr([this, &pollfds, fdcount]() {
-        while (!m_bTerminate) {
-            bool preparedToRead = wl_display_prepare_read(m_sWaylandState.display) == 0;
+    m_sLoopState.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    RASSERT(m_sLoopState.epollFd >= 0, "[core] Couldn't create an epoll instance: {}", strerror(errno));
 
-            int  events = 0;
-            if (preparedToRead) {
-                events = poll(pollfds, fdcount, 5000);
+    addLoopSource(m_sLoopState.epollFd, wl_display_get_fd(m_sWaylandState.display), LOOP_WAYLAND);
+    addLoopSource(m_sLoopState.epollFd, m_sLoopState.timerFd, LOOP_TIMER);
+    addLoopSource(m_sLoopState.epollFd, m_sLoopState.signalFd, LOOP_SIGNAL);
+    if (dbusConn)
+        addLoopSource(m_sLoopState.epollFd, dbusConn->getEventLoopPollData().fd, LOOP_DBUS);
+    if (g_pClock->fd() >= 0)
+        addLoopSource(m_sLoopState.epollFd, g_pClock->fd(), LOOP_CLOCK);
 
-                if (events < 0) {
-                    wl_display_cancel_read(m_sWaylandState.display);
-                    RASSERT(errno == EINTR, "[core] Polling fds failed with {}", errno);
-                }
+    g_pRenderer->startFadeIn();
 
-                for (size_t i = 0; i < fdcount; ++i) {
-                    RASSERT(!(pollfds[i].revents & POLLHUP), "[core] Disconnected from pollfd id {}", i);
-                }
+    std::array<epoll_event, 8> events;
 
-                wl_display_read_events(m_sWaylandState.display);
-                m_sLoopState.wlDispatched = false;
-            }
+    while (!m_bTerminate) {
+        // everything that asked for a render since the last iteration gets exactly one.
+        // Surfaces still waiting on a frame callback render from that callback instead.
+        renderScheduledOutputs();
+
+        // dispatch what has been read already, until libwayland lets us read from the fd ourselves
+        while (wl_display_prepare_read(m_sWaylandState.display) != 0) {
+            wl_display_dispatch_pending(m_sWaylandState.display);
+            renderScheduledOutputs();
+        }
+        wl_display_flush(m_sWaylandState.display);
 
-            if (events > 0 || !preparedToRead) {
-                Debug::log(TRACE, "[core] got poll event");
-                std::unique_lock lk(m_sLoopState.eventLoopMutex);
-                m_sLoopState.event = true;
-                m_sLoopState.loopCV.notify_all();
+        const int NEVENTS = epoll_wait(m_sLoopState.epollFd, events.data(), events.size(), -1);
 
-                m_sLoopState.wlDispatchCV.wait_for(lk, std::chrono::milliseconds(100), [this] { return m_sLoopState.wlDispatched; });
-            }
+        if (NEVENTS < 0) {
+            wl_display_cancel_read(m_sWaylandState.display);
+            RASSERT(errno == EINTR, "[core] Waiting for events failed with {}", errno);
+            continue;
         }
-    });
-
-    std::thread timersThr([this]() {
-        while (!m_bTerminate) {
-            // calc nearest thing
-            m_sLoopState.timersMutex.lock();
 
-            float least = 10000;
-            for (auto& t : m_vTimers) {
-                const auto TIME = std::clamp(t->leftMs(), 1.f, INFINITY);
-                least           = std::min(TIME, least);
+        bool waylandReadable = false;
+        bool dbusReadable    = false;
+        bool signalReadable  = false;
+        bool clockReadable   = false;
+
+        for (int i = 0; i < NEVENTS; ++i) {
+            switch (events[i].data.u64) {
+                case LOOP_WAYLAND:
+                    RASSERT(!(events[i].events & (EPOLLHUP | EPOLLERR)), "[core] Disconnected from the wayland compositor");
+                    waylandReadable = true;
+                    break;
+                case LOOP_TIMER: {
+                    uint64_t expirations = 0;
+                    read(m_sLoopState.timerFd, &expirations, sizeof(expirations));
+                    break;
+                }
+                case LOOP_DBUS:
+                    RASSERT(!(events[i].events & EPOLLHUP), "[core] Disconnected from dbus");
+                    dbusReadable = true;
+                    break;
+                case LOOP_SIGNAL: signalReadable = true; break;
+                case LOOP_CLOCK: clockReadable = true; break;
+                default: break;
             }
-
-            m_sLoopState.timersMutex.unlock();
-
-            std::unique_lock lk(m_sLoopState.timerRequestMutex);
-            m_sLoopState.timerCV.wait_for(lk, std::chrono::milliseconds((int)least + 1), [this] { return m_sLoopState.timerEvent; });
-            m_sLoopState.timerEvent = false;
-
-            // notify main
-            std::lock_guard<std::mutex> lg2(m_sLoopState.eventLoopMutex);
-            Debug::log(TRACE, "timer thread firing");
-            m_sLoopState.event = true;
-            m_sLoopState.loopCV.notify_all();
         }
-    });
-
-    m_sLoopState.event = true; // let it process once
-    g_pRenderer->startFadeIn();
 
-    while (!m_bTerminate) {
-        std::unique_lock lk(m_sLoopState.eventRequestMutex);
-        if (!m_sLoopState.event)
-            m_sLoopState.loopCV.wait_for(lk, std::chrono::milliseconds(5000), [this] { return m_sLoopState.event; });
-
-        if (m_bTerminate)
-            break;
-
-        std::lock_guard<std::mutex> lg(m_sLoopState.eventLoopMutex);
+        if (waylandReadable)
+            wl_display_read_events(m_sWaylandState.display);
+        else
+            wl_display_cancel_read(m_sWaylandState.display);
 
-        m_sLoopState.event = false;
+        Debug::log(TRACE, "[core] got {} loop events", NEVENTS);
 
         wl_display_dispatch_pending(m_sWaylandState.display);
-        wl_display_flush(m_sWaylandState.display);
 
-        m_sLoopState.wlDispatched = true;
-        m_sLoopState.wlDispatchCV.notify_all();
+        if (signalReadable) {
+            signalfd_siginfo info;
+            while (read(m_sLoopState.signalFd, &info, sizeof(info)) == sizeof(info)) {
+                if (info.ssi_signo == SIGUSR1)
+                    handleUnlockSignal(SIGUSR1);
+                else if (info.ssi_signo == SIGUSR2)
+                    handleForceUpdateSignal(SIGUSR2);
+            }
+        }
 
-        if (pollfds[1].revents & POLLIN /* dbus */) {
+        if (dbusReadable) {
             while (dbusConn && dbusConn->processPendingEvent()) {
                 ;
             }
         }
 
-        // do timers
-        m_sLoopState.timersMutex.lock();
-        auto timerscpy = m_vTimers;
-        m_sLoopState.timersMutex.unlock();
-
-        std::vector<std::shared_ptr<CTimer>> passed;
-
-        for (auto& t : timerscpy) {
-            if (t->passed() && !t->cancelled()) {
-                t->call(t);
-                passed.push_back(t);
-            }
-
-            if (t->cancelled())
-                passed.push_back(t);
-        }
+        // clocks show the new zone right away instead of at the next minute
+        if (clockReadable && g_pClock->onFdReadable())
+            forceUpdateTimers(FORCE_UPDATE_TIME);
 
-        m_sLoopState.timersMutex.lock();
-        std::erase_if(m_vTimers, [passed](const auto& timer) { return std::find(passed.begin(), passed.end(), timer) != passed.end(); });
-        m_sLoopState.timersMutex.unlock();
-
-        passed.clear();
+        // cheap when nothing is due, and picks up timers that were due before the timerfd got to fire
+        dispatchTimers();
     }
 
     const auto DPY = m_sWaylandState.display;
 
-    m_sLoopState.timerEvent = true;
-    m_sLoopState.timerCV.notify_all();
     g_pRenderer->asyncResourceGatherer->notify();
     g_pRenderer->asyncResourceGatherer->await();
     m_sWaylandState = {};
@@ -477,18 +471,13 @@ void CMpvlock::run() {  // Updated from CHyprlock
     m_vOutputs.clear();
     g_pEGL.reset();
     g_pRenderer.reset();
+    g_pClock.reset();
     g_pSeatManager.reset();
 
     wl_display_disconnect(DPY);
 
-    pthread_kill(pollThr.native_handle(), SIGRTMIN);
-
     g_pAuth->terminate();
 
-    // wait for threads to exit cleanly to avoid a coredump
-    pollThr.join();
-    timersThr.join();
-
     Debug::log(LOG, "Reached the end, exiting");
 }
 
@@ -506,6 +495,10 @@ void CMpvlock::unlock() {  // Updated from CHyprlock
     renderAllOutputs();
 }
 
+bool CMpvlock::isInGrace() {
+    return clockNow(m_iGraceClock) < m_tGraceEnds;
+}
+
 bool CMpvlock::isUnlocked() {  // Updated from CHyprlock
     return m_bUnlockedCalled || m_bTerminate;
 }
@@ -530,7 +523,7 @@ void CMpvlock::renderOutput(const std::string& stringPort) {  // Updated from CH
     if (!PMONITOR->m_sessionLockSurface)
         return;
 
-    PMONITOR->m_sessionLockSurface->render();
+    PMONITOR->m_sessionLockSurface->scheduleRender();
 }
 
 void CMpvlock::renderAllOutputs() {  // Updated from CHyprlock
@@ -538,7 +531,16 @@ void CMpvlock::renderAllOutputs() {  // Updated from CHyprlock
         if (!o->m_sessionLockSurface)
             continue;
 
-        o->m_sessionLockSurface->render();
+        o->m_sessionLockSurface->scheduleRender();
+    }
+}
+
+void CMpvlock::renderScheduledOutputs() {
+    for (auto& o : m_vOutputs) {
+        if (!o->m_sessionLockSurface)
+            continue;
+
+        o->m_sessionLockSurface->renderIfScheduled();
     }
 }
 
@@ -574,7 +576,7 @@ void CMpvlock::onKey(uint32_t key, bool down) {  // Updated from CHyprlock
     if (isUnlocked())
         return;
 
-    if (down && std::chrono::system_clock::now() < m_tGraceEnds) {
+    if (down && isInGrace()) {
         unlock();
         return;
     }
@@ -789,44 +791,169 @@ size_t CMpvlock::getPasswordBufferDisplayLen() {  // Updated from CHyprlock
     return std::count_if(m_sPasswordState.passBuffer.begin(), m_sPasswordState.passBuffer.end(), [](char c) { return (c & 0xc0) != 0x80; });
 }
 
-std::shared_ptr<CTimer> CMpvlock::addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
-                                            bool force) {  // Updated from CHyprlock
+// heap order, the nearest deadline ends up at the front
+static bool timerExpiresLater(const std::shared_ptr<CTimer>& a, const std::shared_ptr<CTimer>& b) {
+    return a->expiry() > b->expiry();
+}
+
+std::shared_ptr<CTimer> CMpvlock::addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
+                                            bool force, uint32_t forceReasons) {  // Updated from CHyprlock
     std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
-    const auto                  T = m_vTimers.emplace_back(std::make_shared<CTimer>(timeout, cb_, data, force));
-    m_sLoopState.timerEvent       = true;
-    m_sLoopState.timerCV.notify_all();
+    const auto                  T = m_vTimers.emplace_back(std::make_shared<CTimer>(timeout, cb_, data, force, forceReasons));
+    std::ranges::push_heap(m_vTimers, timerExpiresLater);
+
+    // only a new nearest deadline moves the timerfd, this also wakes the loop up when called from another thread
+    if (m_vTimers.front() == T)
+        armTimerFd();
+
     return T;
 }
 
+void CMpvlock::armTimerFd() {
+    // cancelled timers stay in the heap until they come up, don't wake up for them
+    while (!m_vTimers.empty() && m_vTimers.front()->cancelled()) {
+        std::ranges::pop_heap(m_vTimers, timerExpiresLater);
+        m_vTimers.pop_back();
+    }
+
+    // steady_clock is CLOCK_MONOTONIC, so the deadline can be armed as is
+    itimerspec spec = {};
+    if (!m_vTimers.empty()) {
+        const auto EXPIRY     = std::chrono::duration_cast<std::chrono::nanoseconds>(m_vTimers.front()->expiry().time_since_epoch()).count();
+        spec.it_value.tv_sec  = EXPIRY / 1000000000;
+        spec.it_value.tv_nsec = EXPIRY % 1000000000;
+    }
+
+    timerfd_settime(m_sLoopState.timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void CMpvlock::dispatchTimers() {
+    std::vector<std::shared_ptr<CTimer>> due;
+
+    {
+        std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+        while (!m_vTimers.empty() && (m_vTimers.front()->cancelled() || m_vTimers.front()->passed())) {
+            std::ranges::pop_heap(m_vTimers, timerExpiresLater);
+            if (!m_vTimers.back()->cancelled())
+                due.emplace_back(std::move(m_vTimers.back()));
+            m_vTimers.pop_back();
+        }
+    }
+
+    // outside of the lock, callbacks add timers themselves
+    for (auto& t : due) {
+        if (!t->cancelled())
+            t->call(t);
+    }
+
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+    armTimerFd();
+}
+
 std::vector<std::shared_ptr<CTimer>> CMpvlock::getTimers() {  // Updated from CHyprlock
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
     return m_vTimers;
 }
 
-void CMpvlock::enqueueForceUpdateTimers() {  // Updated from CHyprlock
+void CMpvlock::forceUpdateTimers(uint32_t reasons) {
+    for (auto& t : getTimers()) {
+        if (t->canForceUpdate(reasons)) {
+            t->call(t);
+            t->cancel();
+        }
+    }
+
+    // widgets that aren't driven by timers notice the change once asked to draw
+    renderAllOutputs();
+}
+
+void CMpvlock::enqueueForceUpdateTimers(uint32_t reasons) {  // Updated from CHyprlock
     addTimer(
-        std::chrono::milliseconds(1),
-        [](std::shared_ptr<CTimer> self, void* data) {
-            for (auto& t : g_pMpvlock->getTimers()) {  // Updated from g_pHyprlock
-                if (t->canForceUpdate()) {
-                    t->call(t);
-                    t->cancel();
-                }
-            }
-        },
-        nullptr, false);
+        std::chrono::milliseconds(1), [reasons](std::shared_ptr<CTimer> self, void* data) { g_pMpvlock->forceUpdateTimers(reasons); }, nullptr, false);
 }
 
 std::string CMpvlock::spawnSync(const std::string& cmd) {  // Updated from CHyprlock
-    CProcess proc("/bin/sh", {"-c", cmd});
-    if (!proc.runSync()) {
-        Debug::log(ERR, "Failed to run \"{}\"", cmd);
+    int outPipe[2] = {-1, -1};
+    int errPipe[2] = {-1, -1};
+    if (pipe2(outPipe, O_CLOEXEC) != 0 || pipe2(errPipe, O_CLOEXEC) != 0) {
+        Debug::log(ERR, "Failed to run \"{}\": pipe2 failed: {}", cmd, strerror(errno));
+        for (int fd : {outPipe[0], outPipe[1], errPipe[0], errPipe[1]}) {
+            if (fd >= 0)
+                close(fd);
+        }
+        return "";
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+
+    // the mask survives exec, don't pass on the signals the event loop blocked for itself
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    const char* argv[] = {"/bin/sh", "-c", cmd.c_str(), nullptr};
+    pid_t       pid    = -1;
+    const int   RET    = posix_spawn(&pid, "/bin/sh", &actions, &attr, (char* const*)argv, environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    close(outPipe[1]);
+    close(errPipe[1]);
+
+    if (RET != 0) {
+        Debug::log(ERR, "Failed to run \"{}\": {}", cmd, strerror(RET));
+        close(outPipe[0]);
+        close(errPipe[0]);
         return "";
     }
 
-    if (!proc.stdErr().empty())
-        Debug::log(ERR, "Shell command \"{}\" STDERR:\n{}", cmd, proc.stdErr());
+    // drain both, a command filling up the pipe we aren't reading would never exit
+    std::string                 out, err;
+    std::array<pollfd, 2>       fds   = {pollfd{.fd = outPipe[0], .events = POLLIN}, pollfd{.fd = errPipe[0], .events = POLLIN}};
+    std::array<std::string*, 2> sinks = {&out, &err};
+    std::array<char, 1024>      buf;
+    while (fds[0].fd >= 0 || fds[1].fd >= 0) {
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (fds[i].fd < 0 || !fds[i].revents)
+                continue;
+
+            const auto LEN = read(fds[i].fd, buf.data(), buf.size());
+            if (LEN > 0)
+                sinks[i]->append(buf.data(), LEN);
+            else if (LEN == 0 || errno != EINTR) {
+                close(fds[i].fd);
+                // poll skips negative fds
+                fds[i].fd = -1;
+            }
+        }
+    }
+
+    for (const auto& fd : fds) {
+        if (fd.fd >= 0)
+            close(fd.fd);
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        ;
+    }
+
+    if (!err.empty())
+        Debug::log(ERR, "Shell command \"{}\" STDERR:\n{}", cmd, err);
 
-    return proc.stdOut();
+    return out;
 }
 
 SP<CCZwlrScreencopyManagerV1> CMpvlock::getScreencopy() {  // Updated from CHyprlock
@@ -13,7 +13,7 @@
 #include "Timer.hpp"
 #include <memory>
 #include <vector>
-#include <condition_variable>
+#include <mutex>
 #include <optional>
 
 #include <xkbcommon/xkbcommon.h>
@@ -37,10 +37,12 @@ class CMpvlock {
     void                             unlock();
     bool                             isUnlocked();
 
-    std::shared_ptr<CTimer>          addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
-                                              bool force = false);
+    std::shared_ptr<CTimer>          addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
+                                              bool force = false, uint32_t forceReasons = FORCE_UPDATE_ALL);
 
-    void                             enqueueForceUpdateTimers();
+    // fires the force-updatable timers planted for any of the reasons, eForceUpdateReason
+    void                             forceUpdateTimers(uint32_t reasons);
+    void                             enqueueForceUpdateTimers(uint32_t reasons);
 
     void                             onLockLocked();
     void                             onLockFinished();
@@ -56,8 +58,10 @@ class CMpvlock {
     void                             handleKeySym(xkb_keysym_t sym, bool compose);
     void                             clearPasswordBuffer();
 
+    // only mark outputs dirty, the loop renders each of them at most once per iteration or frame callback
     void                             renderOutput(const std::string& stringPort);
     void                             renderAllOutputs();
+    void                             renderScheduledOutputs();
 
     size_t                           getPasswordBufferLen();
     size_t                           getPasswordBufferDisplayLen();
@@ -92,7 +96,10 @@ class CMpvlock {
     std::string                      m_sCurrentDesktop = "";
 
     //
-    std::chrono::system_clock::time_point m_tGraceEnds;
+    // deadline on m_iGraceClock, CLOCK_BOOTTIME keeps counting while the machine is suspended
+    clockid_t                             m_iGraceClock = CLOCK_MONOTONIC;
+    std::chrono::nanoseconds              m_tGraceEnds{0};
+    bool                                  isInGrace();
     Vector2D                              m_vLastEnterCoords = {};
 
     std::shared_ptr<CTimer>               m_pKeyRepeatTimer = nullptr;
@@ -116,6 +123,11 @@ class CMpvlock {
     gbm_device* createGBMDevice(drmDevice* dev);
 
   private:
+    // runs due timers and drops finished ones
+    void dispatchTimers();
+    // points the timerfd at the nearest deadline, timersMutex must be held
+    void armTimerFd();
+
     struct {
         wl_display*                      display     = nullptr;
         SP<CCWlRegistry>                 registry    = nullptr;
@@ -140,22 +152,17 @@ class CMpvlock {
     } m_sPasswordState;
 
     struct {
-        std::mutex              timersMutex;
-        std::mutex              eventRequestMutex;
-        std::mutex              eventLoopMutex;
-        std::condition_variable loopCV;
-        bool                    event = false;
-
-        std::condition_variable wlDispatchCV;
-        bool                    wlDispatched = false;
-
-        std::condition_variable timerCV;
-        std::mutex              timerRequestMutex;
-        bool                    timerEvent = false;
+        // timers get added from the auth and resource threads too
+        std::mutex timersMutex;
+
+        int        epollFd  = -1;
+        int        timerFd  = -1;
+        int        signalFd = -1;
     } m_sLoopState;
 
     bool                                 m_bUnlockedCalled = false;
 
+    // min-heap on the expiry, see addTimer
     std::vector<std::shared_ptr<CTimer>> m_vTimers;
 
     std::vector<uint32_t>                m_vPressedKeys;
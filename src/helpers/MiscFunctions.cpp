@@ -6,6 +6,7 @@
 #include "Log.hpp"
 #include <hyprutils/string/String.hpp>
 #include <unistd.h>
+#include <vector>
 
 using namespace Hyprutils::String;
 
@@ -136,4 +137,46 @@ int createPoolFile(size_t size, std::string& name) {
     }
 
     return FD;
-}
\ No newline at end of file
+}
+
+uint64_t fnv1a(const std::string& str) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const unsigned char c : str) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::filesystem::path cacheDirectory() {
+    static const std::filesystem::path DIR = []() -> std::filesystem::path {
+        if (const char* xdg = getenv("XDG_CACHE_HOME"); xdg && xdg[0] == '/')
+            return std::filesystem::path(xdg) / "mpvlock";
+        if (const char* home = getenv("HOME"); home && home[0] != '\0')
+            return std::filesystem::path(home) / ".cache" / "mpvlock";
+        return {};
+    }();
+
+    return DIR;
+}
+
+void pruneCacheFiles(const std::filesystem::path& dir, const std::string& extension, size_t keep) {
+    std::error_code                               ec;
+    std::vector<std::filesystem::directory_entry> entries;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() == extension)
+            entries.push_back(entry);
+    }
+
+    if (entries.size() <= keep)
+        return;
+
+    std::ranges::sort(entries, [](const auto& a, const auto& b) {
+        std::error_code ec;
+        return a.last_write_time(ec) > b.last_write_time(ec);
+    });
+
+    for (size_t i = keep; i < entries.size(); ++i) {
+        std::filesystem::remove(entries[i].path(), ec);
+    }
+}
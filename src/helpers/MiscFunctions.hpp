@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <string>
 #include <hyprlang.hpp>
 #include <hyprutils/math/Vector2D.hpp>
@@ -7,3 +8,11 @@
 std::string absolutePath(const std::string&, const std::string&);
 int64_t     configStringToInt(const std::string& VALUE);
 int         createPoolFile(size_t size, std::string& name);
+
+// stable across runs, unlike std::hash
+uint64_t              fnv1a(const std::string& str);
+// $XDG_CACHE_HOME/mpvlock, or ~/.cache/mpvlock. Empty if neither is known.
+std::filesystem::path cacheDirectory();
+// removes all but the `keep` most recently written files with that extension from dir.
+// Caches that touch a file on a hit get least-recently-used eviction out of it
+void                  pruneCacheFiles(const std::filesystem::path& dir, const std::string& extension, size_t keep);
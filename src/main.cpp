@@ -2,6 +2,7 @@
 #include "core/mpvlock.hpp"
 #include "helpers/Log.hpp"
 #include "core/AnimationManager.hpp"
+#include "renderer/ImageCache.hpp"
 #include <cstddef>
 #include <string_view>
 
@@ -13,8 +14,9 @@ void help() {
                  "  -c FILE, --config FILE   - Specify config file to use\n"
                  "  --display NAME           - Specify the Wayland display to connect to\n"
                  "  --immediate              - Lock immediately, ignoring any configured grace period\n"
-                 "  --immediate-render       - Do not wait for resources before drawing the background\n"
+                 "  --immediate-render       - Lock right away and draw placeholders until resources are loaded\n"
                  "  --no-fade-in             - Disable the fade-in animation when the lock screen appears\n"
+                 "  --precompile-assets      - Encode the cached images as compressed textures and exit\n"
                  "  -V, --version            - Show version information\n"
                  "  -h, --help               - Show this help message");
 }
@@ -42,6 +44,7 @@ int main(int argc, char** argv, char** envp) {
     bool                     immediate       = false;
     bool                     immediateRender = false;
     bool                     noFadeIn        = false;
+    bool                     precompile      = false;
 
     std::vector<std::string> args(argv, argv + argc);
 
@@ -85,6 +88,9 @@ int main(int argc, char** argv, char** envp) {
         else if (arg == "--no-fade-in")
             noFadeIn = true;
 
+        else if (arg == "--precompile-assets")
+            precompile = true;
+
         else {
             std::println(stderr, "Unknown option: {}", arg);
             help();
@@ -107,6 +113,10 @@ int main(int argc, char** argv, char** envp) {
             throw; // Re-throw to outer catch
         }
 
+        // offline, works on what earlier locks left in the image cache
+        if (precompile)
+            return CImageCache::precompile() ? 0 : 1;
+
         if (noFadeIn)
             g_pConfigManager->m_AnimationTree.setConfigForNode("fadeIn", false, 0.f, "default");
 
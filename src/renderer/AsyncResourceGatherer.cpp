@@ -1,24 +1,79 @@
 #include "AsyncResourceGatherer.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../core/Egl.hpp"
+#include "../core/LockSurface.hpp"
 #include <cairo/cairo.h>
 #include <magic.h>
 #include <pango/pangocairo.h>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <iterator>
 #include "../core/mpvlock.hpp"  // Updated from hyprlock.hpp
 #include "../helpers/MiscFunctions.hpp"
+#include "BlurCache.hpp"
+#include "ImageDecoder.hpp"
+#include "TextureCompressor.hpp"
+#include "Renderer.hpp"
 #include "src/helpers/Color.hpp"
 #include "src/helpers/Log.hpp"
-#include <hyprgraphics/image/Image.hpp>
 using namespace Hyprgraphics;
 
+// the largest viewport of the outputs a widget is on, so images get decoded no larger than that
+static Vector2D coverSizeFor(const std::string& monitor) {
+    Vector2D coverSize;
+    for (auto& o : g_pMpvlock->m_vOutputs) {
+        if (!monitor.empty() && o->stringPort != monitor && !o->stringDesc.starts_with(monitor))
+            continue;
+
+        auto viewport = o->getViewport();
+        // without a lock surface yet this is the mode, which doesn't account for rotation
+        if (!o->m_sessionLockSurface && o->transform % 2 == 1)
+            viewport = {viewport.y, viewport.x};
+
+        coverSize.x = std::max(coverSize.x, viewport.x);
+        coverSize.y = std::max(coverSize.y, viewport.y);
+    }
+
+    return coverSize;
+}
+
 CAsyncResourceGatherer::CAsyncResourceGatherer() {
+    // ETC2 is core in GLES 3, still only trust what the driver lists
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount);
+    std::vector<GLint> formats(std::max(formatCount, 0));
+    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    etc2Supported = std::ranges::find(formats, GL_COMPRESSED_RGB8_ETC2) != formats.end();
+    Debug::log(LOG, "Resource gatherer: ETC2 textures {}", etc2Supported ? "supported" : "not supported");
+
     if (g_pMpvlock->getScreencopy())  // Updated from g_pHyprlock
         enqueueScreencopyFrames();
 
-    initialGatherThread = std::thread([this]() { this->gather(); });
-    asyncLoopThread     = std::thread([this]() { this->asyncAssetSpinLock(); });
+    const size_t WORKERS = std::max(std::thread::hardware_concurrency(), 1u);
+    Debug::log(LOG, "Resource gatherer: decoding on {} threads", WORKERS);
+
+    for (size_t i = 0; i < WORKERS; ++i) {
+        workerThreads.emplace_back([this]() { this->workerLoop(); });
+    }
+
+    // outputs come and go on the main thread, so the size hints are taken here and not by gather()
+    std::unordered_map<std::string, Vector2D> coverSizes;
+    for (const auto& c : g_pConfigManager->getWidgetConfigs()) {
+        if (c.type == "background" && !coverSizes.contains(c.monitor))
+            coverSizes[c.monitor] = coverSizeFor(c.monitor);
+    }
+
+    initialGatherThread = std::thread([this, coverSizes = std::move(coverSizes)]() { this->gather(coverSizes); });
+}
+
+static void addProgress(std::atomic<float>& progress, float step) {
+#if defined(_LIBCPP_VERSION) && _LIBCPP_VERSION < 180100
+    progress = progress + step;
+#else
+    progress += step;
+#endif
 }
 
 void CAsyncResourceGatherer::enqueueScreencopyFrames() {
@@ -57,39 +112,55 @@ void CAsyncResourceGatherer::enqueueScreencopyFrames() {
     }
 }
 
-SPreloadedAsset* CAsyncResourceGatherer::getAssetByID(const std::string& id) {
-    for (auto& a : assets) {
-        if (a.first == id)
-            return &a.second;
-    }
+SPreloadedAsset* SAssetHandle::get() const {
+    if (!g_pRenderer || !g_pRenderer->asyncResourceGatherer)
+        return nullptr;
 
-    if (apply()) {
-        for (auto& a : assets) {
-            if (a.first == id)
-                return &a.second;
-        }
-    };
+    return g_pRenderer->asyncResourceGatherer->getAsset(*this);
+}
+
+SAssetHandle CAsyncResourceGatherer::getAssetByID(const std::string& id) {
+    if (const auto IT = assetSlotByID.find(id); IT != assetSlotByID.end())
+        return {IT->second, assetSlots[IT->second].generation};
 
+    // screencopy frames are filled in by wayland events, they get a slot once they are done
     for (auto& frame : scframes) {
         if (id == frame->m_resourceID)
-            return frame->m_asset.ready ? &frame->m_asset : nullptr;
+            return frame->m_asset.ready ? addAsset(id, nullptr, &frame->m_asset) : SAssetHandle{};
     }
 
-    return nullptr;
+    return {};
 }
 
-static SP<CCairoSurface> getCairoSurfaceFromImageFile(const std::filesystem::path& path) {
-
-    auto image = CImage(path);
-    if (!image.success()) {
-        Debug::log(ERR, "Image {} could not be loaded: {}", path.string(), image.getError());
+SPreloadedAsset* CAsyncResourceGatherer::getAsset(const SAssetHandle& handle) {
+    if (handle.index >= assetSlots.size())
         return nullptr;
+
+    const auto& SLOT = assetSlots[handle.index];
+    return SLOT.generation == handle.generation ? SLOT.asset : nullptr;
+}
+
+SAssetHandle CAsyncResourceGatherer::addAsset(const std::string& id, UP<SPreloadedAsset> owned, SPreloadedAsset* external) {
+    uint32_t index = 0;
+    if (!freeAssetSlots.empty()) {
+        index = freeAssetSlots.back();
+        freeAssetSlots.pop_back();
+    } else {
+        index = assetSlots.size();
+        assetSlots.emplace_back();
     }
 
-    return image.cairoSurface();
+    auto& slot = assetSlots[index];
+    slot.id    = id;
+    slot.asset = owned ? owned.get() : external;
+    slot.owned = std::move(owned);
+
+    assetSlotByID[id] = index;
+
+    return {index, slot.generation};
 }
 
-void CAsyncResourceGatherer::gather() {
+void CAsyncResourceGatherer::gather(const std::unordered_map<std::string, Vector2D>& coverSizes) {
     const auto CWIDGETS = g_pConfigManager->getWidgetConfigs();
 
     g_pEGL->makeCurrent(nullptr);
@@ -101,110 +172,449 @@ void CAsyncResourceGatherer::gather() {
     });
     // clang-format on
 
+    const float       STEP = 1.0 / (preloads + 1.0);
+    std::vector<SJob> decodes;
+
     progress = 0;
     for (auto& c : CWIDGETS) {
         if (c.type == "background" || c.type == "image") {
-#if defined(_LIBCPP_VERSION) && _LIBCPP_VERSION < 180100
-            progress = progress + 1.0 / (preloads + 1.0);
-#else
-            progress += 1.0 / (preloads + 1.0);
-#endif
-
             std::string path = std::any_cast<Hyprlang::STRING>(c.values.at("path"));
 
-            if (path.empty() || path == "screenshot")
+            if (path.empty() || path == "screenshot") {
+                addProgress(progress, STEP);
                 continue;
+            }
+
+            // the blurred result is loaded straight from disk, no need to decode the source.
+            // should the cached entry not match the output after all, the background requests the image itself.
+            if (c.type == "background" && std::any_cast<Hyprlang::INT>(c.values.at("blur_passes")) > 0 && CBlurCache::hasAnyFor(CBlurCache::sourceID(path))) {
+                Debug::log(LOG, "Skipping decode of {}, a blurred version is cached", path);
+                addProgress(progress, STEP);
+                continue;
+            }
 
             std::string id = (c.type == "background" ? std::string{"background:"} : std::string{"image:"}) + path;
 
-            // render the image directly, since we are in a seperate thread
             CAsyncResourceGatherer::SPreloadRequest rq;
             rq.type  = CAsyncResourceGatherer::TARGET_IMAGE;
             rq.asset = path;
             rq.id    = id;
 
-            renderImage(rq);
+            if (c.type == "background") {
+                rq.sizeHint  = coverSizes.at(c.monitor);
+                rq.thumbnail = true;
+            } else {
+                const double SIZE = std::any_cast<Hyprlang::INT>(c.values.at("size"));
+                rq.sizeHint       = {SIZE, SIZE};
+            }
+
+            // one image shown by several widgets is decoded once, large enough for all of them
+            if (const auto IT = std::ranges::find_if(decodes, [&id](const auto& job) { return job.request.id == id; }); IT != decodes.end()) {
+                IT->request.sizeHint.x = std::max(IT->request.sizeHint.x, rq.sizeHint.x);
+                IT->request.sizeHint.y = std::max(IT->request.sizeHint.y, rq.sizeHint.y);
+                addProgress(progress, STEP);
+                continue;
+            }
+
+            decodes.push_back({rq, true});
         }
     }
 
+    // decode all of them in parallel, so we are done once the slowest single image is
+    {
+        std::unique_lock lk(asyncLoopState.requestsMutex);
+
+        // an image some widget requested already is shared instead
+        std::erase_if(decodes, [this, STEP](const auto& job) {
+            if (asyncLoopState.inFlight.contains(job.request.id)) {
+                addProgress(progress, STEP);
+                return true;
+            }
+
+            asyncLoopState.inFlight[job.request.id] = {};
+            return false;
+        });
+
+        asyncLoopState.initialRemaining = decodes.size();
+        asyncLoopState.initialStep      = STEP;
+        asyncLoopState.jobs.insert(asyncLoopState.jobs.begin(), decodes.begin(), decodes.end());
+        asyncLoopState.requestsCV.notify_all();
+
+        asyncLoopState.initialCV.wait(lk, [this] { return asyncLoopState.initialRemaining == 0 || g_pMpvlock->m_bTerminate; });
+    }
+
     while (!g_pMpvlock->m_bTerminate && std::ranges::any_of(scframes, [](const auto& d) { return !d->m_asset.ready; })) {  // Updated from g_pHyprlock
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
     gathered = true;
+
+    // outputs that held back their widgets until now draw them
+    g_pMpvlock->addTimer(
+        std::chrono::milliseconds(0),
+        [](auto, auto) {
+            for (auto& o : g_pMpvlock->m_vOutputs) {
+                if (o->m_sessionLockSurface)
+                    o->m_sessionLockSurface->damageEntire();
+            }
+
+            g_pMpvlock->renderAllOutputs();
+        },
+        nullptr);
 }
 
+// how much apply() copies into the upload buffer per pass. A 4K wallpaper takes a few passes,
+// and every loop iteration in between still dispatches input and renders.
+constexpr size_t UPLOAD_BUDGET = 8 * 1024 * 1024;
+
 bool CAsyncResourceGatherer::apply() {
     preloadTargetsMutex.lock();
+    // moved, so the surfaces and mappings are only ever released here
+    auto currentPreloadTargets = std::move(preloadTargets);
+    preloadTargets.clear();
+    preloadTargetsMutex.unlock();
+
+    for (auto& t : currentPreloadTargets) {
+        if (t.type == TARGET_IMAGE)
+            startUpload(std::move(t));
+        else
+            Debug::log(ERR, "Unsupported type in ::apply(): {}", (int)t.type);
+    }
 
-    if (preloadTargets.empty()) {
-        preloadTargetsMutex.unlock();
+    if (uploads.empty())
         return false;
+
+    size_t                             budget   = UPLOAD_BUDGET;
+    bool                               finished = false;
+    std::vector<std::function<void()>> callbacks;
+    while (!uploads.empty() && budget > 0) {
+        if (!uploadBand(uploads.front(), budget))
+            break;
+
+        auto upload = std::move(uploads.front());
+        uploads.pop_front();
+
+        finishUpload(upload);
+        std::ranges::move(upload.callbacks, std::back_inserter(callbacks));
+        finished = true;
     }
 
-    auto currentPreloadTargets = preloadTargets;
-    preloadTargets.clear();
-    preloadTargetsMutex.unlock();
+    if (uploads.empty()) {
+        glDeleteBuffers(1, &uploadPBO);
+        uploadPBO = 0;
+    } else if (!uploadPassScheduled) {
+        uploadPassScheduled = true;
+        g_pMpvlock->addTimer(
+            std::chrono::milliseconds(0),
+            [this](auto, auto) {
+                uploadPassScheduled = false;
+                apply();
+            },
+            nullptr);
+    }
 
-    for (auto& t : currentPreloadTargets) {
-        if (t.type == TARGET_IMAGE) {
-            const auto           ASSET = &assets[t.id];
-
-            const cairo_status_t SURFACESTATUS = (cairo_status_t)t.cairosurface->status();
-            const auto           CAIROFORMAT   = cairo_image_surface_get_format(t.cairosurface->cairo());
-            const GLint          glIFormat     = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB32F : GL_RGBA;
-            const GLint          glFormat      = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB : GL_RGBA;
-            const GLint          glType        = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_FLOAT : GL_UNSIGNED_BYTE;
-
-            if (SURFACESTATUS != CAIRO_STATUS_SUCCESS) {
-                Debug::log(ERR, "Resource {} invalid ({})", t.id, cairo_status_to_string(SURFACESTATUS));
-                ASSET->texture.m_iType = TEXTURE_INVALID;
-            }
+    if (!finished)
+        return false;
 
-            ASSET->texture.m_vSize = t.size;
-            ASSET->texture.allocate();
+    // widgets that are still waiting for one of these draw it with the next frame
+    for (auto& o : g_pMpvlock->m_vOutputs) {
+        if (o->m_sessionLockSurface)
+            o->m_sessionLockSurface->damageEntire();
+    }
 
-            glBindTexture(GL_TEXTURE_2D, ASSET->texture.m_iTexID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            if (CAIROFORMAT != CAIRO_FORMAT_RGB96F) {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-            }
-            glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, ASSET->texture.m_vSize.x, ASSET->texture.m_vSize.y, 0, glFormat, glType, t.data);
+    g_pMpvlock->renderAllOutputs();
 
-            cairo_destroy((cairo_t*)t.cairo);
-            t.cairosurface.reset();
-        } else
-            Debug::log(ERR, "Unsupported type in ::apply(): {}", (int)t.type);
+    for (auto& cb : callbacks) {
+        cb();
     }
 
     return true;
 }
 
-void CAsyncResourceGatherer::renderImage(const SPreloadRequest& rq) {
+// general:min_filter, the mipmapped ones make heavy downscaling both cheaper and alias free
+static GLint configuredMinFilter() {
+    static const auto MINFILTER = g_pConfigManager->getValue<Hyprlang::STRING>("general:min_filter");
+    static const auto FILTER    = [] {
+        const std::string VALUE = *MINFILTER;
+        if (VALUE == "linear")
+            return GL_LINEAR;
+        if (VALUE == "nearest")
+            return GL_NEAREST;
+        if (VALUE == "linear_mipmap_linear")
+            return GL_LINEAR_MIPMAP_LINEAR;
+        if (VALUE == "linear_mipmap_nearest")
+            return GL_LINEAR_MIPMAP_NEAREST;
+        if (VALUE == "nearest_mipmap_linear")
+            return GL_NEAREST_MIPMAP_LINEAR;
+        if (VALUE == "nearest_mipmap_nearest")
+            return GL_NEAREST_MIPMAP_NEAREST;
+
+        Debug::log(WARN, "Unknown general:min_filter {}, using linear", VALUE);
+        return GL_LINEAR;
+    }();
+
+    return FILTER;
+}
+
+void CAsyncResourceGatherer::startUpload(SPreloadTarget&& t) {
+    SUpload upload;
+    upload.asset = makeUnique<SPreloadedAsset>();
+
+    // precompiled, small enough to go up in one piece with all of its levels
+    if (t.mapping && t.mapping->compressedLevels > 0) {
+        auto& tex   = upload.asset->texture;
+        tex.m_vSize = t.size;
+        tex.allocate();
+
+        glBindTexture(GL_TEXTURE_2D, tex.m_iTexID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, configuredMinFilter());
+        glTexStorage2D(GL_TEXTURE_2D, t.mapping->compressedLevels, GL_COMPRESSED_RGB8_ETC2, t.size.x, t.size.y);
+
+        const uint8_t* level = t.mapping->pixels;
+        int            w = t.size.x, h = t.size.y;
+        for (uint32_t i = 0; i < t.mapping->compressedLevels; ++i, w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+            const size_t SIZE = CTextureCompressor::etc2Size(w, h);
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, w, h, GL_COMPRESSED_RGB8_ETC2, SIZE, level);
+            level += SIZE;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        upload.rowsDone = t.size.y;
+        upload.target   = std::move(t);
+        uploads.push_back(std::move(upload));
+        return;
+    }
+
+    // image cache entries are always ARGB32
+    const cairo_status_t SURFACESTATUS = t.cairosurface ? (cairo_status_t)t.cairosurface->status() : CAIRO_STATUS_SUCCESS;
+    const auto           CAIROFORMAT   = t.cairosurface ? cairo_image_surface_get_format(t.cairosurface->cairo()) : CAIRO_FORMAT_ARGB32;
+    const GLenum         glIFormat     = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB32F : GL_RGBA8;
+    upload.format                      = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB : GL_RGBA;
+    upload.type                        = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_FLOAT : GL_UNSIGNED_BYTE;
+
+    auto& tex    = upload.asset->texture;
+    tex.m_vSize  = t.size;
+    upload.width = t.size.x;
+
+    upload.bytesPerPixel = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? 12 : 4;
+    upload.rowBytes      = (size_t)upload.width * upload.bytesPerPixel;
+    upload.stride        = t.cairosurface ? cairo_image_surface_get_stride(t.cairosurface->cairo()) : upload.rowBytes;
+
+    if (SURFACESTATUS != CAIRO_STATUS_SUCCESS) {
+        Debug::log(ERR, "Resource {} invalid ({})", t.id, cairo_status_to_string(SURFACESTATUS));
+        tex.m_iType = TEXTURE_INVALID;
+        // nothing worth uploading
+        upload.rowsDone = tex.m_vSize.y;
+    }
+
+    // float textures can't have mipmaps generated
+    const GLint MINFILTER = t.image && CAIROFORMAT != CAIRO_FORMAT_RGB96F ? configuredMinFilter() : GL_LINEAR;
+    upload.mipmaps        = MINFILTER != GL_LINEAR && MINFILTER != GL_NEAREST;
+
+    const int   HEIGHT = tex.m_vSize.y;
+    const int   LEVELS = upload.mipmaps ? (int)std::floor(std::log2(std::max({upload.width, HEIGHT, 1}))) + 1 : 1;
+
+    tex.allocate();
+
+    glBindTexture(GL_TEXTURE_2D, tex.m_iTexID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MINFILTER);
+    if (CAIROFORMAT != CAIRO_FORMAT_RGB96F) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+    // immutable, the pixels follow band by band in uploadBand(). Empty text has no size, which storage doesn't accept.
+    if (upload.width > 0 && HEIGHT > 0)
+        glTexStorage2D(GL_TEXTURE_2D, LEVELS, glIFormat, upload.width, HEIGHT);
+    else
+        upload.rowsDone = HEIGHT;
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    upload.target = std::move(t);
+    uploads.push_back(std::move(upload));
+}
+
+bool CAsyncResourceGatherer::uploadBand(SUpload& upload, size_t& budget) {
+    const int HEIGHT = upload.asset->texture.m_vSize.y;
+    if (upload.rowsDone >= HEIGHT)
+        return true;
+
+    const int      ROWS  = std::clamp<int>(budget / std::max<size_t>(upload.rowBytes, 1), 1, HEIGHT - upload.rowsDone);
+    const size_t   BYTES = (size_t)ROWS * upload.rowBytes;
+    const uint8_t* SRC   = (const uint8_t*)upload.target.data + (size_t)upload.rowsDone * upload.stride;
+
+    if (!uploadPBO)
+        glGenBuffers(1, &uploadPBO);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPBO);
+    // orphaned every band, so we never wait for the driver to finish with the previous one
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, BYTES, nullptr, GL_STREAM_DRAW);
+
+    glBindTexture(GL_TEXTURE_2D, upload.asset->texture.m_iTexID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (auto* dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, BYTES, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT); dst) {
+        // rows are packed tightly in the buffer
+        for (int y = 0; y < ROWS; ++y) {
+            std::memcpy(dst + (size_t)y * upload.rowBytes, SRC + (size_t)y * upload.stride, upload.rowBytes);
+        }
+
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.rowsDone, upload.width, ROWS, upload.format, upload.type, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        Debug::log(WARN, "Failed to map the upload buffer, uploading {} directly", upload.target.id);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, upload.stride / upload.bytesPerPixel);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.rowsDone, upload.width, ROWS, upload.format, upload.type, SRC);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    upload.rowsDone += ROWS;
+    budget = BYTES >= budget ? 0 : budget - BYTES;
+
+    return upload.rowsDone >= HEIGHT;
+}
+
+void CAsyncResourceGatherer::finishUpload(SUpload& upload) {
+    auto& t = upload.target;
+
+    if (upload.mipmaps && upload.asset->texture.m_iType != TEXTURE_INVALID) {
+        glBindTexture(GL_TEXTURE_2D, upload.asset->texture.m_iTexID);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    {
+        // from now on, new requests find it in the asset slots
+        std::lock_guard lg(asyncLoopState.requestsMutex);
+        if (const auto IT = asyncLoopState.inFlight.find(t.id); IT != asyncLoopState.inFlight.end()) {
+            upload.asset->refs += IT->second.refs;
+            asyncLoopState.inFlight.erase(IT);
+        }
+    }
+
+    if (const auto SLOT = assetSlotByID.find(t.id); SLOT != assetSlotByID.end()) {
+        // handles to the old one stay valid and see the new texture
+        auto& slot = assetSlots[SLOT->second];
+        upload.asset->refs += slot.asset->refs;
+        slot.owned = std::move(upload.asset);
+        slot.asset = slot.owned.get();
+    } else
+        addAsset(t.id, std::move(upload.asset));
+
+    if (t.cairo)
+        cairo_destroy((cairo_t*)t.cairo);
+    t.cairosurface.reset();
+    t.mapping.reset();
+}
+
+bool CAsyncResourceGatherer::renderImage(const SPreloadRequest& rq) {
     SPreloadTarget target;
     target.type = TARGET_IMAGE;
     target.id   = rq.id;
 
+    // the decoded size is part of the key, a different output layout decodes again
+    const auto SOURCEID = CBlurCache::sourceID(rq.asset);
+    const auto SOURCE   = SOURCEID.empty() ? "" : std::format("{}@{}x{}", SOURCEID, (int)rq.sizeHint.x, (int)rq.sizeHint.y);
+
+    // a warm start maps the decoded pixels, apply() uploads straight from the mapping.
+    // Variants compressed by --precompile-assets are preferred.
+    auto mapping = etc2Supported ? CImageCache::loadCompressed(SOURCE) : nullptr;
+    if (!mapping)
+        mapping = CImageCache::load(SOURCE);
+
+    if (mapping) {
+        // caches from before thumbnails existed
+        if (rq.thumbnail && mapping->compressedLevels == 0 && !CImageCache::loadThumbnail(SOURCEID)) {
+            const auto W       = (int)mapping->size.x;
+            auto       surface = cairo_image_surface_create_for_data((unsigned char*)mapping->pixels, CAIRO_FORMAT_ARGB32, W, mapping->size.y, W * 4);
+            CImageCache::storeThumbnail(SOURCEID, surface);
+            cairo_surface_destroy(surface);
+        }
+
+        target.image   = true;
+        target.data    = (void*)mapping->pixels;
+        target.size    = mapping->size;
+        target.mapping = std::move(mapping);
+
+        std::lock_guard lg{preloadTargetsMutex};
+        preloadTargets.push_back(std::move(target));
+
+        return true;
+    }
+
     std::filesystem::path ABSOLUTEPATH(absolutePath(rq.asset, ""));
-    const auto            CAIROISURFACE = getCairoSurfaceFromImageFile(ABSOLUTEPATH);
+    const auto            CAIROISURFACE = CImageDecoder::decode(ABSOLUTEPATH, rq.sizeHint);
 
     if (!CAIROISURFACE) {
         Debug::log(ERR, "renderImage: No cairo surface!");
-        return;
+        return false;
     }
 
+    CImageCache::store(SOURCE, CAIROISURFACE->cairo());
+    if (rq.thumbnail)
+        CImageCache::storeThumbnail(SOURCEID, CAIROISURFACE->cairo());
+
     const auto CAIRO = cairo_create(CAIROISURFACE->cairo());
     cairo_scale(CAIRO, 1, 1);
 
+    target.image        = true;
     target.cairo        = CAIRO;
     target.cairosurface = CAIROISURFACE;
     target.data         = CAIROISURFACE->data();
     target.size         = CAIROISURFACE->size();
 
     std::lock_guard lg{preloadTargetsMutex};
-    preloadTargets.push_back(target);
+    preloadTargets.push_back(std::move(target));
+
+    return true;
+}
+
+// pango objects aren't thread safe, so every thread rendering text keeps its own, for as long as it lives
+struct SPangoThreadState {
+    SPangoThreadState() {
+        fontMap = pango_cairo_font_map_new();
+        context = pango_font_map_create_context(fontMap);
+
+        // what an image surface would have set on a context created from it
+        auto* options = cairo_font_options_create();
+        cairo_font_options_set_hint_metrics(options, CAIRO_HINT_METRICS_ON);
+        pango_cairo_context_set_font_options(context, options);
+        cairo_font_options_destroy(options);
+    }
+
+    ~SPangoThreadState() {
+        for (auto& [key, desc] : fontDescs) {
+            pango_font_description_free(desc);
+        }
+
+        g_object_unref(context);
+        g_object_unref(fontMap);
+    }
+
+    const PangoFontDescription* fontDesc(const std::string& family, int size) {
+        auto& desc = fontDescs[std::format("{}@{}", family, size)];
+        if (!desc) {
+            desc = pango_font_description_from_string(family.c_str());
+            pango_font_description_set_size(desc, size * PANGO_SCALE);
+        }
+
+        return desc;
+    }
+
+    PangoFontMap*                                          fontMap = nullptr;
+    PangoContext*                                          context = nullptr;
+    std::unordered_map<std::string, PangoFontDescription*> fontDescs;
+};
+
+static SPangoThreadState& pangoThreadState() {
+    thread_local SPangoThreadState state;
+    return state;
 }
 
 void CAsyncResourceGatherer::renderText(const SPreloadRequest& rq) {
@@ -225,16 +635,11 @@ void CAsyncResourceGatherer::renderText(const SPreloadRequest& rq) {
         text.erase(text.find_last_not_of(" \n\r\t") + 1);
     }
 
-    auto CAIROSURFACE = makeShared<CCairoSurface>(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1920, 1080 /* dummy value */));
-    auto CAIRO        = cairo_create(CAIROSURFACE->cairo());
-
-    // draw title using Pango
-    PangoLayout*          layout = pango_cairo_create_layout(CAIRO);
+    auto&        pango  = pangoThreadState();
 
-    PangoFontDescription* fontDesc = pango_font_description_from_string(FONTFAMILY.c_str());
-    pango_font_description_set_size(fontDesc, FONTSIZE * PANGO_SCALE);
-    pango_layout_set_font_description(layout, fontDesc);
-    pango_font_description_free(fontDesc);
+    // measured without a surface, only the final one is allocated
+    PangoLayout* layout = pango_layout_new(pango.context);
+    pango_layout_set_font_description(layout, pango.fontDesc(FONTFAMILY, FONTSIZE));
 
     if (rq.props.contains("text_align")) {
         const std::string TEXTALIGN = std::any_cast<std::string>(rq.props.at("text_align"));
@@ -271,10 +676,8 @@ void CAsyncResourceGatherer::renderText(const SPreloadRequest& rq) {
     int layoutWidth, layoutHeight;
     pango_layout_get_size(layout, &layoutWidth, &layoutHeight);
 
-    // TODO: avoid this?
-    cairo_destroy(CAIRO);
-    CAIROSURFACE = makeShared<CCairoSurface>(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, layoutWidth / PANGO_SCALE, layoutHeight / PANGO_SCALE));
-    CAIRO        = cairo_create(CAIROSURFACE->cairo());
+    auto CAIROSURFACE = makeShared<CCairoSurface>(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, layoutWidth / PANGO_SCALE, layoutHeight / PANGO_SCALE));
+    auto CAIRO        = cairo_create(CAIROSURFACE->cairo());
 
     // clear the pixmap
     cairo_save(CAIRO);
@@ -301,68 +704,148 @@ void CAsyncResourceGatherer::renderText(const SPreloadRequest& rq) {
     preloadTargets.push_back(target);
 }
 
-void CAsyncResourceGatherer::asyncAssetSpinLock() {
-    while (!g_pMpvlock->m_bTerminate) {  // Updated from g_pHyprlock
-
+void CAsyncResourceGatherer::workerLoop() {
+    while (!g_pMpvlock->m_bTerminate) {
         std::unique_lock lk(asyncLoopState.requestsMutex);
-        if (!asyncLoopState.pending) // avoid a lock if a thread managed to request something already since we .unlock()ed
-            asyncLoopState.requestsCV.wait_for(lk, std::chrono::seconds(5), [this] { return asyncLoopState.pending; }); // wait for events
-
-        asyncLoopState.pending = false;
+        if (asyncLoopState.jobs.empty())
+            asyncLoopState.requestsCV.wait_for(lk, std::chrono::seconds(5), [this] { return !asyncLoopState.jobs.empty() || g_pMpvlock->m_bTerminate; });
 
-        if (asyncLoopState.requests.empty()) {
-            lk.unlock();
+        if (asyncLoopState.jobs.empty())
             continue;
-        }
 
-        auto requests = asyncLoopState.requests;
-        asyncLoopState.requests.clear();
+        const auto JOB = std::move(asyncLoopState.jobs.front());
+        asyncLoopState.jobs.pop_front();
 
         lk.unlock();
 
-        // process requests
-        for (auto& r : requests) {
-            Debug::log(TRACE, "Processing requested resourceID {}", r.id);
+        const auto& r = JOB.request;
 
-            if (r.type == TARGET_TEXT) {
-                renderText(r);
-            } else if (r.type == TARGET_IMAGE) {
-                renderImage(r);
-            } else {
-                Debug::log(ERR, "Unsupported async preload type {}??", (int)r.type);
-                continue;
-            }
+        Debug::log(TRACE, "Processing requested resourceID {}", r.id);
 
-            // plant timer for callback
-            if (r.callback)
-                g_pMpvlock->addTimer(std::chrono::milliseconds(0), [cb = r.callback](auto, auto) { cb(); }, nullptr);  // Updated from g_pHyprlock
+        bool decoded = false;
+        if (r.type == TARGET_TEXT) {
+            renderText(r);
+            decoded = true;
+        } else if (r.type == TARGET_IMAGE) {
+            decoded = renderImage(r);
+        } else
+            Debug::log(ERR, "Unsupported async preload type {}??", (int)r.type);
+
+        lk.lock();
+
+        if (JOB.initial) {
+            addProgress(progress, asyncLoopState.initialStep);
+            if (--asyncLoopState.initialRemaining == 0)
+                asyncLoopState.initialCV.notify_all();
+        }
+
+        // everyone who asked for this id in the meantime gets called back too, after the upload
+        std::vector<std::function<void()>> callbacks;
+        if (const auto IT = asyncLoopState.inFlight.find(r.id); IT != asyncLoopState.inFlight.end()) {
+            callbacks = std::move(IT->second.callbacks);
+            IT->second.callbacks.clear();
+            IT->second.decoded = true;
+
+            // nothing is coming for apply() to pick up, the next request has to try again
+            if (!decoded)
+                asyncLoopState.inFlight.erase(IT);
         }
+
+        lk.unlock();
+
+        scheduleApply(r.id, std::move(callbacks));
     }
 }
 
+void CAsyncResourceGatherer::scheduleApply(const std::string& id, std::vector<std::function<void()>> callbacks) {
+    g_pMpvlock->addTimer(
+        std::chrono::milliseconds(0),
+        [this, id, callbacks = std::move(callbacks)](auto, auto) mutable {
+            apply();
+
+            // still streaming in, they fire once it is done
+            if (const auto IT = std::ranges::find_if(uploads, [&id](const auto& u) { return u.target.id == id; }); IT != uploads.end()) {
+                std::ranges::move(callbacks, std::back_inserter(IT->callbacks));
+                return;
+            }
+
+            for (auto& cb : callbacks) {
+                cb();
+            }
+        },
+        nullptr);
+}
+
 void CAsyncResourceGatherer::requestAsyncAssetPreload(const SPreloadRequest& request) {
     Debug::log(TRACE, "Requesting label resource {}", request.id);
 
     std::lock_guard<std::mutex> lg(asyncLoopState.requestsMutex);
-    asyncLoopState.requests.push_back(request);
-    asyncLoopState.pending = true;
-    asyncLoopState.requestsCV.notify_all();
+
+    if (const auto IT = asyncLoopState.inFlight.find(request.id); IT != asyncLoopState.inFlight.end()) {
+        Debug::log(TRACE, "Resource {} is already being loaded, sharing it", request.id);
+
+        IT->second.refs++;
+        if (request.callback) {
+            if (IT->second.decoded)
+                scheduleApply(request.id, {request.callback});
+            else
+                IT->second.callbacks.push_back(request.callback);
+        }
+        return;
+    }
+
+    if (const auto IT = assetSlotByID.find(request.id); IT != assetSlotByID.end()) {
+        Debug::log(TRACE, "Resource {} is already loaded, sharing it", request.id);
+
+        assetSlots[IT->second].asset->refs++;
+        if (request.callback)
+            scheduleApply(request.id, {request.callback});
+        return;
+    }
+
+    auto& entry = asyncLoopState.inFlight[request.id];
+    entry.refs  = 1;
+    if (request.callback)
+        entry.callbacks.push_back(request.callback);
+
+    asyncLoopState.jobs.push_back({request});
+    asyncLoopState.requestsCV.notify_one();
 }
 
-void CAsyncResourceGatherer::unloadAsset(SPreloadedAsset* asset) {
-    std::erase_if(assets, [asset](const auto& a) { return &a.second == asset; });
+void CAsyncResourceGatherer::unloadAsset(const SAssetHandle& asset) {
+    const auto PASSET = getAsset(asset);
+    if (!PASSET)
+        return;
+
+    // still used by another widget
+    if (PASSET->refs > 1) {
+        PASSET->refs--;
+        return;
+    }
+
+    auto& slot = assetSlots[asset.index];
+    assetSlotByID.erase(slot.id);
+    slot.id.clear();
+    slot.owned.reset();
+    slot.asset = nullptr;
+    // outstanding handles to it resolve to nullptr from now on
+    slot.generation++;
+    freeAssetSlots.push_back(asset.index);
 }
 
 void CAsyncResourceGatherer::notify() {
     std::lock_guard<std::mutex> lg(asyncLoopState.requestsMutex);
-    asyncLoopState.requests.clear();
-    asyncLoopState.pending = true;
+    // initial gather jobs stay, gather() waits for them
+    std::erase_if(asyncLoopState.jobs, [](const auto& j) { return !j.initial; });
     asyncLoopState.requestsCV.notify_all();
+    asyncLoopState.initialCV.notify_all();
 }
 
 void CAsyncResourceGatherer::await() {
     if (initialGatherThread.joinable())
         initialGatherThread.join();
-    if (asyncLoopThread.joinable())
-        asyncLoopThread.join();
+    for (auto& t : workerThreads) {
+        if (t.joinable())
+            t.join();
+    }
 }
\ No newline at end of file
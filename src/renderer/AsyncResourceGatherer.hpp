@@ -3,11 +3,14 @@
 #include "Screencopy.hpp"
 #include <thread>
 #include <atomic>
+#include <deque>
 #include <vector>
 #include <unordered_map>
 #include <condition_variable>
 #include <any>
 #include "Shared.hpp"
+#include "ImageCache.hpp"
+#include "../helpers/Math.hpp"
 #include <hyprgraphics/cairo/CairoSurface.hpp>
 
 class CAsyncResourceGatherer {
@@ -18,8 +21,14 @@ class CAsyncResourceGatherer {
     std::atomic<float> progress = 0;
 
     /* only call from ogl thread */
-    SPreloadedAsset* getAssetByID(const std::string& id);
-
+    // an empty handle if the asset isn't loaded (yet)
+    SAssetHandle     getAssetByID(const std::string& id);
+    // nullptr for an empty handle or an unloaded asset
+    SPreloadedAsset* getAsset(const SAssetHandle& handle);
+
+    // uploads what the decoders finished, through a pixel buffer and a few MiB per call. Scheduled on the main
+    // thread after every decode and again while uploads are left, repaints the outputs once one of them completes
+    // so that widgets waiting for an asset pick it up.
     bool             apply();
 
     enum eTargetType {
@@ -34,33 +43,63 @@ class CAsyncResourceGatherer {
 
         std::unordered_map<std::string, std::any> props;
 
+        // optional, for images. They are decoded at the smallest size that still covers it.
+        // Requests joining one in flight get whatever size that one was decoded at.
+        Vector2D sizeHint;
+        // also keep a thumbnail of it for the next lock, see CImageCache::storeThumbnail
+        bool     thumbnail = false;
+
         // optional. Callbacks will be dispatched from the main thread,
         // so wayland/gl calls are OK.
         // will fire once the resource is fully loaded and ready.
         std::function<void()> callback = nullptr;
     };
 
+    // requests for an id that is already loaded or being loaded share that asset instead of decoding it again
     void requestAsyncAssetPreload(const SPreloadRequest& request);
-    void unloadAsset(SPreloadedAsset* asset);
+    // drops one reference, the asset is freed once the last one is gone
+    void unloadAsset(const SAssetHandle& asset);
     void notify();
     void await();
 
   private:
-    std::thread asyncLoopThread;
-    std::thread initialGatherThread;
+    // decoders, one per core. They share one queue, which both the initial gather and later requests feed.
+    std::vector<std::thread> workerThreads;
+    std::thread              initialGatherThread;
+
+    // whether to use ETC2 entries of the image cache. Set before the decoders start.
+    bool                     etc2Supported = false;
 
-    void        asyncAssetSpinLock();
-    void        renderText(const SPreloadRequest& rq);
-    void        renderImage(const SPreloadRequest& rq);
+    void                     workerLoop();
+    void                     renderText(const SPreloadRequest& rq);
+    bool                     renderImage(const SPreloadRequest& rq);
+
+    struct SJob {
+        SPreloadRequest request;
+        // part of the initial gather, counts towards progress and gathered
+        bool            initial = false;
+    };
 
     struct {
-        std::condition_variable      requestsCV;
-        std::mutex                   requestsMutex;
+        std::condition_variable requestsCV;
+        std::mutex              requestsMutex;
+
+        std::deque<SJob>        jobs;
 
-        std::vector<SPreloadRequest> requests;
-        bool                         pending = false;
+        // initial gather jobs not finished yet, guarded by requestsMutex
+        size_t                  initialRemaining = 0;
+        float                   initialStep      = 0;
+        std::condition_variable initialCV;
 
-        bool                         busy = false;
+        struct SInFlight {
+            // requests waiting for this one. Decodes of the initial gather start with none.
+            size_t                             refs    = 0;
+            bool                               decoded = false;
+            std::vector<std::function<void()>> callbacks;
+        };
+
+        // queued or decoding, or decoded but not uploaded by apply() yet. Keyed by resource id.
+        std::unordered_map<std::string, SInFlight> inFlight;
     } asyncLoopState;
 
     struct SPreloadTarget {
@@ -70,6 +109,10 @@ class CAsyncResourceGatherer {
         void*                           data  = nullptr;
         void*                           cairo = nullptr;
         SP<Hyprgraphics::CCairoSurface> cairosurface;
+        // set instead of cairo/cairosurface when the pixels come from the image cache
+        SP<CImageCache::CMapping>       mapping;
+        // decoded from a file rather than rendered text, drawn scaled and so filtered as general:min_filter says
+        bool                            image = false;
 
         Vector2D                        size;
     };
@@ -79,8 +122,50 @@ class CAsyncResourceGatherer {
     std::vector<SPreloadTarget>                      preloadTargets;
     std::mutex                                       preloadTargetsMutex;
 
-    std::unordered_map<std::string, SPreloadedAsset> assets;
+    struct SAssetSlot {
+        std::string         id;
+        UP<SPreloadedAsset> owned;
+        // owned, or the asset of a screencopy frame. nullptr while the slot is free
+        SPreloadedAsset*    asset      = nullptr;
+        uint32_t            generation = 0;
+    };
+
+    std::vector<SAssetSlot>                          assetSlots;
+    std::vector<uint32_t>                            freeAssetSlots;
+    std::unordered_map<std::string, uint32_t>        assetSlotByID;
+
+    SAssetHandle                                     addAsset(const std::string& id, UP<SPreloadedAsset> owned, SPreloadedAsset* external = nullptr);
+    // runs apply() and then the callbacks on the main thread, or once id is uploaded if that takes more passes
+    void                                             scheduleApply(const std::string& id, std::vector<std::function<void()>> callbacks);
+
+    struct SUpload {
+        SPreloadTarget                     target;
+        // becomes the slot's asset once all rows are in
+        UP<SPreloadedAsset>                asset;
+
+        GLenum                             format        = GL_RGBA;
+        GLenum                             type          = GL_UNSIGNED_BYTE;
+        int                                width         = 0;
+        size_t                             bytesPerPixel = 4;
+        size_t                             rowBytes      = 0;
+        size_t                             stride        = 0;
+        int                                rowsDone      = 0;
+        bool                               mipmaps       = false;
+
+        std::vector<std::function<void()>> callbacks;
+    };
+
+    // main thread only, uploaded in order
+    std::deque<SUpload>                              uploads;
+    GLuint                                           uploadPBO           = 0;
+    bool                                             uploadPassScheduled = false;
+
+    void                                             startUpload(SPreloadTarget&& t);
+    // streams as many rows as the budget allows and takes them off it. True once the texture is complete.
+    bool                                             uploadBand(SUpload& upload, size_t& budget);
+    void                                             finishUpload(SUpload& upload);
 
-    void                                             gather();
+    // coverSizes: size hint of backgrounds by monitor, taken on the main thread
+    void                                             gather(const std::unordered_map<std::string, Vector2D>& coverSizes);
     void                                             enqueueScreencopyFrames();
 };
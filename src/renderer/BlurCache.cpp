@@ -0,0 +1,237 @@
+#include "BlurCache.hpp"
+#include "../helpers/Log.hpp"
+#include "../helpers/MiscFunctions.hpp"
+#include <GLES3/gl32.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// bump when the layout or the blur shaders change, old entries are then ignored and pruned
+constexpr char   BLURCACHE_MAGIC[8]    = {'M', 'P', 'V', 'L', 'B', 'L', 'R', '1'};
+constexpr size_t BLURCACHE_MAXFILES    = 16;
+constexpr char   BLURCACHE_EXTENSION[] = ".blur";
+
+struct SBlurCacheHeader {
+    char     magic[8];
+    uint32_t width     = 0;
+    uint32_t height    = 0;
+    uint32_t keyLength = 0;
+    uint32_t padding   = 0;
+};
+
+static std::string keyFor(const std::string& source, const std::string& variant) {
+    return source + "\n" + variant;
+}
+
+CBlurCache::~CBlurCache() {
+    for (auto& writer : m_writers) {
+        if (writer.joinable())
+            writer.join();
+    }
+}
+
+std::string CBlurCache::sourceID(const std::string& path) {
+    try {
+        const auto ABSPATH = absolutePath(path, "");
+
+        struct stat st;
+        if (stat(ABSPATH.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            return "";
+
+        return std::format("{}:{}.{}:{}", ABSPATH, st.st_mtim.tv_sec, st.st_mtim.tv_nsec, st.st_size);
+    } catch (std::exception& e) {
+        Debug::log(WARN, "Blur cache: failed to stat {}: {}", path, e.what());
+        return "";
+    }
+}
+
+std::filesystem::path CBlurCache::pathFor(const std::string& source, const std::string& variant) {
+    const auto DIR = cacheDirectory();
+    if (DIR.empty())
+        return {};
+
+    return DIR / std::format("{:016x}-{:016x}{}", fnv1a(source), fnv1a(variant), BLURCACHE_EXTENSION);
+}
+
+bool CBlurCache::hasAnyFor(const std::string& source) {
+    const auto DIR = cacheDirectory();
+    if (source.empty() || DIR.empty())
+        return false;
+
+    const auto PREFIX = std::format("{:016x}-", fnv1a(source));
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(DIR, ec)) {
+        if (entry.path().filename().string().starts_with(PREFIX))
+            return true;
+    }
+
+    return false;
+}
+
+SP<CTexture> CBlurCache::get(const std::string& source, const std::string& variant) {
+    if (source.empty())
+        return nullptr;
+
+    const auto KEY = keyFor(source, variant);
+
+    if (const auto IT = m_textures.find(KEY); IT != m_textures.end()) {
+        if (const auto TEX = IT->second.lock())
+            return TEX;
+        m_textures.erase(IT);
+    }
+
+    auto tex = load(source, variant);
+    if (tex)
+        m_textures[KEY] = tex;
+
+    return tex;
+}
+
+SP<CTexture> CBlurCache::load(const std::string& source, const std::string& variant) {
+    const auto PATH = pathFor(source, variant);
+    if (PATH.empty())
+        return nullptr;
+
+    const int fd = open(PATH.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SBlurCacheHeader)) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    SP<CTexture>     tex;
+    SBlurCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const auto   KEY      = keyFor(source, variant);
+    const size_t PIXELLEN = (size_t)header.width * header.height * 4;
+    const auto*  KEYPTR   = (const char*)data + sizeof(header);
+
+    // a hash collision or a truncated write just means a miss
+    if (std::memcmp(header.magic, BLURCACHE_MAGIC, sizeof(BLURCACHE_MAGIC)) == 0 && header.keyLength == KEY.size() &&
+        (size_t)st.st_size == sizeof(header) + header.keyLength + PIXELLEN && std::memcmp(KEYPTR, KEY.data(), KEY.size()) == 0) {
+        tex = makeShared<CTexture>();
+        tex->allocate();
+        tex->m_vSize = {(double)header.width, (double)header.height};
+
+        glBindTexture(GL_TEXTURE_2D, tex->m_iTexID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, header.width, header.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, KEYPTR + header.keyLength);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // pruning goes by mtime, a hit keeps the blur in daily use from being the one evicted
+        std::error_code ec;
+        std::filesystem::last_write_time(PATH, std::filesystem::file_time_type::clock::now(), ec);
+
+        Debug::log(LOG, "Blur cache: loaded {}x{} from {}", header.width, header.height, PATH.string());
+    } else
+        Debug::log(WARN, "Blur cache: ignoring stale or corrupt entry {}", PATH.string());
+
+    munmap(data, st.st_size);
+    return tex;
+}
+
+SP<CTexture> CBlurCache::store(const std::string& source, const std::string& variant, CFramebuffer& fb, bool persist) {
+    if (source.empty() || !fb.isAllocated())
+        return nullptr;
+
+    const auto KEY = keyFor(source, variant);
+
+    // another output got there first, no need for a second readback
+    if (const auto IT = m_textures.find(KEY); IT != m_textures.end()) {
+        if (const auto TEX = IT->second.lock()) {
+            fb.release();
+            return TEX;
+        }
+    }
+
+    const int  WIDTH  = fb.m_vSize.x;
+    const int  HEIGHT = fb.m_vSize.y;
+    const auto PATH   = persist && !m_persisted.contains(KEY) ? pathFor(source, variant) : std::filesystem::path{};
+
+    if (!PATH.empty()) {
+        // one synchronous readback per image, the file itself is written off-thread
+        std::vector<uint8_t> pixels((size_t)WIDTH * HEIGHT * 4);
+
+        GLint                prevReadFb = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevReadFb);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.m_iFb);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, prevReadFb);
+
+        m_persisted.insert(KEY);
+        m_writers.emplace_back([PATH, KEY, WIDTH, HEIGHT, pixels = std::move(pixels)]() {
+            std::error_code ec;
+            std::filesystem::create_directories(PATH.parent_path(), ec);
+            if (ec) {
+                Debug::log(ERR, "Blur cache: failed to create {}: {}", PATH.parent_path().string(), ec.message());
+                return;
+            }
+
+            SBlurCacheHeader header;
+            std::memcpy(header.magic, BLURCACHE_MAGIC, sizeof(BLURCACHE_MAGIC));
+            header.width     = WIDTH;
+            header.height    = HEIGHT;
+            header.keyLength = KEY.size();
+
+            // write-then-rename, so a reader never sees a half-written file
+            const auto TMPPATH = std::filesystem::path(PATH.string() + std::format(".{}.{}.tmp", getpid(), gettid()));
+            {
+                std::ofstream ofs(TMPPATH, std::ios::binary | std::ios::trunc);
+                ofs.write((const char*)&header, sizeof(header));
+                ofs.write(KEY.data(), KEY.size());
+                ofs.write((const char*)pixels.data(), pixels.size());
+                if (!ofs.good()) {
+                    Debug::log(ERR, "Blur cache: failed to write {}", TMPPATH.string());
+                    ofs.close();
+                    std::filesystem::remove(TMPPATH, ec);
+                    return;
+                }
+            }
+
+            std::filesystem::rename(TMPPATH, PATH, ec);
+            if (ec) {
+                Debug::log(ERR, "Blur cache: failed to rename {}: {}", TMPPATH.string(), ec.message());
+                std::filesystem::remove(TMPPATH, ec);
+                return;
+            }
+
+            Debug::log(LOG, "Blur cache: wrote {}", PATH.string());
+
+            pruneCacheFiles(PATH.parent_path(), BLURCACHE_EXTENSION, BLURCACHE_MAXFILES);
+        });
+    }
+
+    // steal the texture, the framebuffer object itself is of no use anymore
+    auto tex           = makeShared<CTexture>();
+    tex->m_iTexID      = fb.m_cTex.m_iTexID;
+    tex->m_vSize       = fb.m_vSize;
+    tex->m_bAllocated  = true;
+    fb.m_cTex.m_iTexID = 0;
+    fb.release();
+
+    m_textures[KEY] = tex;
+
+    return tex;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "Texture.hpp"
+#include "Framebuffer.hpp"
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Keeps blurred background results around so they are computed once per image instead of once per output and lock.
+// Entries are keyed by the source image (path, mtime, size) and a variant string describing everything else
+// the result depends on (viewport, blur params). Results are shared in memory and persisted to
+// $XDG_CACHE_HOME/mpvlock, so the next lock can skip both decoding and blurring.
+class CBlurCache {
+  public:
+    ~CBlurCache();
+
+    // empty if the file can't be stat'ed, which disables caching for it
+    static std::string           sourceID(const std::string& path);
+    // whether any blur of this source is on disk, used to skip decoding it at startup
+    static bool                  hasAnyFor(const std::string& source);
+
+    SP<CTexture>                 get(const std::string& source, const std::string& variant);
+    // takes over the texture of fb and releases the rest of it. persist writes the result to disk in the background.
+    // if another output already stored the same blur, that texture is returned and fb is just released.
+    SP<CTexture>                 store(const std::string& source, const std::string& variant, CFramebuffer& fb, bool persist);
+
+  private:
+    static std::filesystem::path pathFor(const std::string& source, const std::string& variant);
+
+    SP<CTexture>                 load(const std::string& source, const std::string& variant);
+
+    std::unordered_map<std::string, WP<CTexture>> m_textures;
+    // keys written or being written this run, each blur hits the disk once
+    std::unordered_set<std::string>               m_persisted;
+    // joined on destruction, so no half-written temp file is left behind
+    std::vector<std::thread>                      m_writers;
+};
@@ -0,0 +1,55 @@
+#include "FramebufferPool.hpp"
+#include "../helpers/Log.hpp"
+
+static size_t bytesFor(const Vector2D& size, bool highres) {
+    // RGBA16F vs RGB10_A2
+    return (size_t)size.x * (size_t)size.y * (highres ? 8 : 4);
+}
+
+CFramebufferPool::CFramebufferPool(size_t maxIdleBytes) : m_maxIdleBytes(maxIdleBytes) {
+    ;
+}
+
+SP<CFramebuffer> CFramebufferPool::acquire(int w, int h, bool highres) {
+    // most recently released first, it is the most likely to still be warm
+    for (auto it = m_idle.rbegin(); it != m_idle.rend(); ++it) {
+        if (it->highres != highres || it->fb->m_vSize != Vector2D{w, h})
+            continue;
+
+        auto fb = it->fb;
+        m_idleBytes -= it->bytes;
+        m_idle.erase(std::next(it).base());
+        return fb;
+    }
+
+    auto fb = makeShared<CFramebuffer>();
+    fb->alloc(w, h, highres);
+    Debug::log(TRACE, "Framebuffer pool: allocated {}x{} (highres: {}), {} idle bytes", w, h, highres, m_idleBytes);
+    return fb;
+}
+
+void CFramebufferPool::release(const SP<CFramebuffer>& fb, bool highres) {
+    if (!fb || !fb->isAllocated())
+        return;
+
+    const auto BYTES = bytesFor(fb->m_vSize, highres);
+
+    m_idle.emplace_back(SIdleFB{.fb = fb, .highres = highres, .bytes = BYTES});
+    m_idleBytes += BYTES;
+
+    evict();
+}
+
+void CFramebufferPool::evict() {
+    // always keep the last released one, even if it alone is over the cap, or blurring big outputs would realloc every time
+    while (m_idleBytes > m_maxIdleBytes && m_idle.size() > 1) {
+        Debug::log(TRACE, "Framebuffer pool: evicting {}x{}", m_idle.front().fb->m_vSize.x, m_idle.front().fb->m_vSize.y);
+        m_idleBytes -= m_idle.front().bytes;
+        m_idle.erase(m_idle.begin());
+    }
+}
+
+void CFramebufferPool::clear() {
+    m_idle.clear();
+    m_idleBytes = 0;
+}
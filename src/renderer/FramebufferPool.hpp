@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "Framebuffer.hpp"
+#include <cstdint>
+#include <vector>
+
+// Recycles scratch framebuffers (e.g. the blur mirrors) instead of allocating them for every use.
+// Idle framebuffers are kept keyed by size and format and evicted least recently used first once they exceed the memory cap.
+class CFramebufferPool {
+  public:
+    CFramebufferPool(size_t maxIdleBytes);
+
+    // returns a framebuffer of exactly w x h, to be handed back with release() once done
+    SP<CFramebuffer> acquire(int w, int h, bool highres);
+    void             release(const SP<CFramebuffer>& fb, bool highres);
+
+    // drops all idle framebuffers, e.g. when outputs go away and their sizes won't be needed again
+    void             clear();
+
+  private:
+    struct SIdleFB {
+        SP<CFramebuffer> fb;
+        bool             highres = false;
+        size_t           bytes   = 0;
+    };
+
+    void                 evict();
+
+    // oldest release first
+    std::vector<SIdleFB> m_idle;
+    size_t               m_idleBytes = 0;
+    size_t               m_maxIdleBytes;
+};
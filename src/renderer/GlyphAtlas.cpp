@@ -0,0 +1,414 @@
+#include "GlyphAtlas.hpp"
+#include "../config/ConfigManager.hpp"
+#include "../helpers/Log.hpp"
+#include <algorithm>
+#include <cairo/cairo.h>
+#include <cmath>
+#include <pango/pangocairo.h>
+
+constexpr int    ATLAS_PAGE_SIZE = 1024;
+// 4 MiB each, plenty for a couple of fonts and sizes
+constexpr size_t ATLAS_MAX_PAGES = 4;
+// transparent border around every glyph, keeps filtering from picking up a neighbour
+constexpr int    GLYPH_PADDING = 1;
+
+CGlyphAtlas::CGlyphAtlas() {
+    m_context = pango_font_map_create_context(pango_cairo_font_map_get_default());
+
+    // measure like renderText does, so a label keeps its size when it falls back to being rasterized
+    auto* options = cairo_font_options_create();
+    cairo_font_options_set_hint_metrics(options, CAIRO_HINT_METRICS_ON);
+    // glyphs are blended at arbitrary positions and rotations, subpixel AA would only fringe
+    cairo_font_options_set_antialias(options, CAIRO_ANTIALIAS_GRAY);
+    pango_cairo_context_set_font_options(m_context, options);
+    cairo_font_options_destroy(options);
+}
+
+CGlyphAtlas::~CGlyphAtlas() {
+    for (auto& page : m_pages) {
+        glDeleteTextures(1, &page.texture);
+    }
+
+    for (auto* font : m_fonts) {
+        g_object_unref(font);
+    }
+
+    g_object_unref(m_context);
+}
+
+bool CGlyphAtlas::reserve(int width, int height, size_t& page, int& x, int& y) {
+    if (width > ATLAS_PAGE_SIZE || height > ATLAS_PAGE_SIZE)
+        return false;
+
+    // simple shelf packing, only the last page takes new glyphs
+    if (!m_pages.empty()) {
+        auto& last = m_pages.back();
+        if (last.cursorX + width > ATLAS_PAGE_SIZE) {
+            last.shelfY += last.shelfHeight;
+            last.shelfHeight = 0;
+            last.cursorX     = 0;
+        }
+
+        if (last.shelfY + height <= ATLAS_PAGE_SIZE) {
+            page = m_pages.size() - 1;
+            x    = last.cursorX;
+            y    = last.shelfY;
+
+            last.cursorX += width;
+            last.shelfHeight = std::max(last.shelfHeight, height);
+            return true;
+        }
+    }
+
+    if (m_pages.size() >= ATLAS_MAX_PAGES) {
+        Debug::log(WARN, "Glyph atlas: out of pages, falling back to rasterized text");
+        return false;
+    }
+
+    auto& newPage = m_pages.emplace_back();
+    glGenTextures(1, &newPage.texture);
+    glBindTexture(GL_TEXTURE_2D, newPage.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // cairo hands out BGRA
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+
+    // storage is undefined until written, and the gaps between glyphs do get sampled at their edges
+    const std::vector<uint8_t> CLEAR((size_t)ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, CLEAR.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    Debug::log(LOG, "Glyph atlas: allocated page {}", m_pages.size());
+
+    return reserve(width, height, page, x, y);
+}
+
+const CGlyphAtlas::SGlyph* CGlyphAtlas::glyphFor(PangoFont* font, PangoGlyph glyph) {
+    const SGlyphKey KEY = {font, glyph};
+    if (const auto IT = m_glyphs.find(KEY); IT != m_glyphs.end())
+        return &IT->second;
+
+    auto* scaledFont = pango_cairo_font_get_scaled_font(PANGO_CAIRO_FONT(font));
+    if (!scaledFont || cairo_scaled_font_status(scaledFont) != CAIRO_STATUS_SUCCESS)
+        return nullptr;
+
+    cairo_glyph_t        cairoGlyph = {glyph, 0, 0};
+    cairo_text_extents_t extents;
+    cairo_scaled_font_glyph_extents(scaledFont, &cairoGlyph, 1, &extents);
+
+    SGlyph entry;
+    if (extents.width > 0 && extents.height > 0) {
+        entry.x      = (int)std::floor(extents.x_bearing) - GLYPH_PADDING;
+        entry.y      = (int)std::floor(extents.y_bearing) - GLYPH_PADDING;
+        entry.width  = (int)std::ceil(extents.x_bearing + extents.width) + GLYPH_PADDING - entry.x;
+        entry.height = (int)std::ceil(extents.y_bearing + extents.height) + GLYPH_PADDING - entry.y;
+
+        int pageX = 0, pageY = 0;
+        if (!reserve(entry.width, entry.height, entry.page, pageX, pageY))
+            return nullptr;
+
+        auto* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, entry.width, entry.height);
+        auto* cairo   = cairo_create(surface);
+        cairo_set_scaled_font(cairo, scaledFont);
+        cairo_set_source_rgba(cairo, 1.0, 1.0, 1.0, 1.0);
+        cairoGlyph.x = -entry.x;
+        cairoGlyph.y = -entry.y;
+        cairo_show_glyphs(cairo, &cairoGlyph, 1);
+        cairo_destroy(cairo);
+        cairo_surface_flush(surface);
+
+        const auto* DATA   = cairo_image_surface_get_data(surface);
+        const int   STRIDE = cairo_image_surface_get_stride(surface);
+
+        // white comes out as gray levels, anything else was drawn in the glyph's own colors
+        for (int row = 0; row < entry.height && !entry.colored; ++row) {
+            const auto* PIXELS = (const uint32_t*)(DATA + (size_t)row * STRIDE);
+            for (int col = 0; col < entry.width; ++col) {
+                const uint32_t A = PIXELS[col] >> 24;
+                if ((PIXELS[col] & 0xFF) != A || ((PIXELS[col] >> 8) & 0xFF) != A || ((PIXELS[col] >> 16) & 0xFF) != A) {
+                    entry.colored = true;
+                    break;
+                }
+            }
+        }
+
+        glBindTexture(GL_TEXTURE_2D, m_pages[entry.page].texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, STRIDE / 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, pageX, pageY, entry.width, entry.height, GL_RGBA, GL_UNSIGNED_BYTE, DATA);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        cairo_surface_destroy(surface);
+
+        entry.uvTopLeft     = {pageX / (double)ATLAS_PAGE_SIZE, pageY / (double)ATLAS_PAGE_SIZE};
+        entry.uvBottomRight = {(pageX + entry.width) / (double)ATLAS_PAGE_SIZE, (pageY + entry.height) / (double)ATLAS_PAGE_SIZE};
+    }
+
+    if (std::ranges::find(m_fonts, font) == m_fonts.end())
+        m_fonts.push_back((PangoFont*)g_object_ref(font));
+
+    return &(m_glyphs[KEY] = entry);
+}
+
+// foreground color of a run, false if it carries decorations that aren't glyphs
+static bool colorForRun(PangoLayoutRun* run, CHyprColor& color) {
+    for (GSList* it = run->item->analysis.extra_attrs; it; it = it->next) {
+        const auto* ATTR = (const PangoAttribute*)it->data;
+        switch (ATTR->klass->type) {
+            case PANGO_ATTR_FOREGROUND: {
+                const auto& COLOR = ((const PangoAttrColor*)ATTR)->color;
+                color.r           = COLOR.red / 65535.0;
+                color.g           = COLOR.green / 65535.0;
+                color.b           = COLOR.blue / 65535.0;
+                break;
+            }
+            case PANGO_ATTR_FOREGROUND_ALPHA: color.a = ((const PangoAttrInt*)ATTR)->value / 65535.0; break;
+            case PANGO_ATTR_UNDERLINE:
+            case PANGO_ATTR_STRIKETHROUGH:
+            case PANGO_ATTR_OVERLINE:
+                if (((const PangoAttrInt*)ATTR)->value != 0)
+                    return false;
+                break;
+            case PANGO_ATTR_BACKGROUND:
+            case PANGO_ATTR_BACKGROUND_ALPHA:
+            case PANGO_ATTR_SHAPE: return false;
+            default: break;
+        }
+    }
+
+    return true;
+}
+
+static CGlyphAtlas::SBatch& batchFor(CGlyphAtlas::SMesh& mesh, GLuint texture) {
+    auto batch = std::ranges::find_if(mesh.batches, [texture](const auto& b) { return b.texture == texture; });
+    if (batch != mesh.batches.end())
+        return *batch;
+
+    return mesh.batches.emplace_back(CGlyphAtlas::SBatch{texture, {}});
+}
+
+// one glyph as two triangles in layout pixels, clipped to the logical box like the rasterized bitmap would be
+static void appendQuad(CGlyphAtlas::SMesh& mesh, GLuint texture, CBox box, Vector2D uv1, Vector2D uv2, const CHyprColor& color) {
+    const double X1 = std::max(box.x, 0.0), Y1 = std::max(box.y, 0.0);
+    const double X2 = std::min(box.x + box.w, mesh.size.x), Y2 = std::min(box.y + box.h, mesh.size.y);
+    if (X1 >= X2 || Y1 >= Y2)
+        return;
+
+    const Vector2D UVSCALE = (uv2 - uv1) / Vector2D{box.w, box.h};
+    const Vector2D CLIPUV1 = uv1 + Vector2D{X1 - box.x, Y1 - box.y} * UVSCALE;
+    const Vector2D CLIPUV2 = uv1 + Vector2D{X2 - box.x, Y2 - box.y} * UVSCALE;
+
+    const auto VERTEX = [&](double x, double y, double u, double v) -> CGlyphAtlas::SVertex {
+        return {
+            .x = (float)x,
+            .y = (float)y,
+            .u = (float)u,
+            .v = (float)v,
+            .r = (float)(color.r * color.a),
+            .g = (float)(color.g * color.a),
+            .b = (float)(color.b * color.a),
+            .a = (float)color.a,
+        };
+    };
+
+    const auto TL = VERTEX(X1, Y1, CLIPUV1.x, CLIPUV1.y);
+    const auto TR = VERTEX(X2, Y1, CLIPUV2.x, CLIPUV1.y);
+    const auto BL = VERTEX(X1, Y2, CLIPUV1.x, CLIPUV2.y);
+    const auto BR = VERTEX(X2, Y2, CLIPUV2.x, CLIPUV2.y);
+
+    auto& vertices = batchFor(mesh, texture).vertices;
+    vertices.insert(vertices.end(), {TL, TR, BL, TR, BR, BL});
+}
+
+// lines that can be shaped on their own, empty if markup spans several of them
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    for (size_t begin = 0;;) {
+        const auto END = text.find('\n', begin);
+        lines.emplace_back(text.substr(begin, END == std::string::npos ? std::string::npos : END - begin));
+        if (END == std::string::npos)
+            break;
+        begin = END + 1;
+    }
+
+    if (lines.size() < 2 || text.find_first_of("<&") == std::string::npos)
+        return lines;
+
+    for (const auto& line : lines) {
+        if (!pango_parse_markup(line.c_str(), -1, 0, nullptr, nullptr, nullptr, nullptr))
+            return {};
+    }
+
+    return lines;
+}
+
+bool CGlyphAtlas::layout(const SLayoutParams& params, SMesh& out, SLineCache* cache) {
+    static const auto TRIM = g_pConfigManager->getValue<Hyprlang::INT>("general:text_trim");
+    std::string       text = params.text;
+
+    if (*TRIM) {
+        text.erase(0, text.find_first_not_of(" \n\r\t"));
+        text.erase(text.find_last_not_of(" \n\r\t") + 1);
+    }
+
+    const auto LINES = cache ? splitLines(text) : std::vector<std::string>{};
+
+    SMesh      mesh;
+    if (LINES.size() < 2) {
+        if (cache)
+            cache->lines.clear();
+
+        if (!shape(text, params, mesh))
+            return false;
+    } else {
+        // only lines whose text changed are shaped again, the rest is stacked from the cache like pango would
+        cache->lines.resize(LINES.size());
+        for (size_t i = 0; i < LINES.size(); ++i) {
+            auto& line = cache->lines[i];
+            if (line.shaped && line.text == LINES[i])
+                continue;
+
+            line = {.text = LINES[i]};
+            if (!shape(line.text, params, line.mesh))
+                return false;
+            line.shaped = true;
+        }
+
+        for (const auto& line : cache->lines) {
+            mesh.size.x = std::max(mesh.size.x, line.mesh.size.x);
+        }
+
+        for (const auto& line : cache->lines) {
+            double offsetX = 0;
+            if (params.textAlign == "center")
+                offsetX = std::round((mesh.size.x - line.mesh.size.x) / 2.0);
+            else if (params.textAlign == "right")
+                offsetX = mesh.size.x - line.mesh.size.x;
+
+            for (const auto& batch : line.mesh.batches) {
+                auto& vertices = batchFor(mesh, batch.texture).vertices;
+                for (auto vertex : batch.vertices) {
+                    vertex.x += offsetX;
+                    vertex.y += mesh.size.y;
+                    vertices.push_back(vertex);
+                }
+            }
+
+            mesh.size.y += line.mesh.size.y;
+        }
+    }
+
+    for (auto& batch : mesh.batches) {
+        for (auto& vertex : batch.vertices) {
+            vertex.x /= mesh.size.x;
+            vertex.y /= mesh.size.y;
+        }
+    }
+
+    out = std::move(mesh);
+    return true;
+}
+
+bool CGlyphAtlas::shape(const std::string& text, const SLayoutParams& params, SMesh& out) {
+    PangoLayout*          layout = pango_layout_new(m_context);
+
+    PangoFontDescription* fontDesc = pango_font_description_from_string(params.fontFamily.c_str());
+    pango_font_description_set_size(fontDesc, params.fontSize * PANGO_SCALE);
+    pango_layout_set_font_description(layout, fontDesc);
+    pango_font_description_free(fontDesc);
+
+    if (!params.textAlign.empty()) {
+        PangoAlignment align = PANGO_ALIGN_LEFT;
+        if (params.textAlign == "center")
+            align = PANGO_ALIGN_CENTER;
+        else if (params.textAlign == "right")
+            align = PANGO_ALIGN_RIGHT;
+
+        pango_layout_set_alignment(layout, align);
+    }
+
+    PangoAttrList* attrList = nullptr;
+    GError*        gError   = nullptr;
+    char*          buf      = nullptr;
+    if (pango_parse_markup(text.c_str(), -1, 0, &attrList, &buf, nullptr, &gError))
+        pango_layout_set_text(layout, buf, -1);
+    else {
+        Debug::log(ERR, "Pango markup parsing for {} failed: {}", text, gError->message);
+        g_error_free(gError);
+        pango_layout_set_text(layout, text.c_str(), -1);
+    }
+
+    if (buf)
+        free(buf);
+
+    if (attrList) {
+        pango_layout_set_attributes(layout, attrList);
+        pango_attr_list_unref(attrList);
+    }
+
+    int layoutWidth, layoutHeight;
+    pango_layout_get_size(layout, &layoutWidth, &layoutHeight);
+
+    SMesh mesh;
+    mesh.size = {layoutWidth / (double)PANGO_SCALE, layoutHeight / (double)PANGO_SCALE};
+
+    bool             ok   = true;
+    PangoLayoutIter* iter = pango_layout_get_iter(layout);
+    do {
+        auto* run = pango_layout_iter_get_run_readonly(iter);
+        if (!run)
+            continue;
+
+        CHyprColor color = params.color;
+        if (!colorForRun(run, color)) {
+            ok = false;
+            break;
+        }
+
+        PangoRectangle logical;
+        pango_layout_iter_get_run_extents(iter, nullptr, &logical);
+
+        // rise is folded into the run's offset
+        const int BASELINE = pango_layout_iter_get_baseline(iter) - run->y_offset;
+        int       penX     = logical.x;
+
+        for (int i = 0; i < run->glyphs->num_glyphs && ok; ++i) {
+            const auto& INFO = run->glyphs->glyphs[i];
+            const int   X    = penX + INFO.geometry.x_offset;
+            const int   Y    = BASELINE + INFO.geometry.y_offset;
+            penX += INFO.geometry.width;
+
+            if (INFO.glyph == PANGO_GLYPH_EMPTY)
+                continue;
+
+            // hex boxes for missing glyphs are drawn by pango itself
+            const auto* GLYPH = (INFO.glyph & PANGO_GLYPH_UNKNOWN_FLAG) ? nullptr : glyphFor(run->item->analysis.font, INFO.glyph);
+            if (!GLYPH) {
+                ok = false;
+                break;
+            }
+
+            if (GLYPH->width == 0)
+                continue;
+
+            // whole pixels, so glyphs stay as crisp as in a rasterized layout
+            const CBox BOX = {(double)PANGO_PIXELS(X) + GLYPH->x, (double)PANGO_PIXELS(Y) + GLYPH->y, (double)GLYPH->width, (double)GLYPH->height};
+            appendQuad(mesh, m_pages[GLYPH->page].texture, BOX, GLYPH->uvTopLeft, GLYPH->uvBottomRight,
+                       GLYPH->colored ? CHyprColor(1.0, 1.0, 1.0, color.a) : color);
+        }
+    } while (ok && pango_layout_iter_next_run(iter));
+
+    pango_layout_iter_free(iter);
+    g_object_unref(layout);
+
+    if (ok)
+        out = std::move(mesh);
+
+    return ok;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../helpers/Color.hpp"
+#include "../helpers/Math.hpp"
+#include <GLES3/gl32.h>
+#include <pango/pango.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Draws text as quads sampling glyphs out of a few shared texture pages. Pango only shapes the text,
+// each glyph is rasterized and uploaded once per font and size, so changing a label just rebuilds its vertices.
+// Main thread only, it owns GL textures.
+class CGlyphAtlas {
+  public:
+    CGlyphAtlas();
+    ~CGlyphAtlas();
+
+    struct SVertex {
+        // position relative to the text box, 0-1
+        float x = 0, y = 0;
+        float u = 0, v = 0;
+        // premultiplied
+        float r = 0, g = 0, b = 0, a = 0;
+    };
+
+    // triangles sampling one page
+    struct SBatch {
+        GLuint               texture = 0;
+        std::vector<SVertex> vertices;
+    };
+
+    struct SMesh {
+        std::vector<SBatch> batches;
+        // logical extents of the layout, the same size the rasterized bitmap would have
+        Vector2D            size;
+    };
+
+    struct SLayoutParams {
+        std::string text;
+        std::string fontFamily = "Sans";
+        std::string textAlign;
+        int         fontSize = 16;
+        CHyprColor  color    = CHyprColor(1.0, 1.0, 1.0, 1.0);
+    };
+
+    // shaped lines of one label's last text, so an update only shapes the lines that changed
+    struct SLineCache {
+        struct SLine {
+            std::string text;
+            // in layout pixels
+            SMesh       mesh;
+            bool        shaped = false;
+        };
+
+        std::vector<SLine> lines;
+    };
+
+    // false if the text needs something quads can't do (underlines, backgrounds, missing glyphs)
+    // or the atlas ran out of room, the caller then rasterizes the whole string instead
+    bool layout(const SLayoutParams& params, SMesh& out, SLineCache* cache = nullptr);
+
+  private:
+    struct SGlyph {
+        // ink box relative to the pen position on the baseline, empty for blank glyphs
+        int      x = 0, y = 0, width = 0, height = 0;
+        size_t   page = 0;
+        Vector2D uvTopLeft, uvBottomRight;
+        // emoji and friends keep their own colors, only alpha is applied to them
+        bool     colored = false;
+    };
+
+    struct SPage {
+        GLuint texture = 0;
+        int    shelfY = 0, shelfHeight = 0, cursorX = 0;
+    };
+
+    struct SGlyphKey {
+        PangoFont* font  = nullptr;
+        PangoGlyph glyph = 0;
+
+        bool       operator==(const SGlyphKey&) const = default;
+    };
+
+    struct SGlyphKeyHash {
+        size_t operator()(const SGlyphKey& key) const {
+            return std::hash<void*>{}(key.font) ^ (std::hash<uint32_t>{}(key.glyph) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    // mesh in layout pixels
+    bool                                                 shape(const std::string& text, const SLayoutParams& params, SMesh& out);
+    const SGlyph*                                        glyphFor(PangoFont* font, PangoGlyph glyph);
+    bool                                                 reserve(int width, int height, size_t& page, int& x, int& y);
+
+    PangoContext*                                        m_context = nullptr;
+    std::vector<SPage>                                   m_pages;
+    std::unordered_map<SGlyphKey, SGlyph, SGlyphKeyHash> m_glyphs;
+    // a reference is held on every font with glyphs in the atlas, so its pointer can't be reused by another one
+    std::vector<PangoFont*>                              m_fonts;
+};
@@ -0,0 +1,327 @@
+#include "ImageCache.hpp"
+#include "BlurCache.hpp"
+#include "TextureCompressor.hpp"
+#include "../helpers/Log.hpp"
+#include "../helpers/MiscFunctions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// bump when the layout changes, old entries are then ignored and pruned
+constexpr char   IMAGECACHE_MAGIC[8]          = {'M', 'P', 'V', 'L', 'I', 'M', 'G', '1'};
+constexpr char   IMAGECACHE_ETC2_MAGIC[8]     = {'M', 'P', 'V', 'L', 'E', 'T', 'C', '1'};
+constexpr char   IMAGECACHE_THUMB_MAGIC[8]    = {'M', 'P', 'V', 'L', 'T', 'H', 'M', '1'};
+constexpr size_t IMAGECACHE_MAXFILES          = 8;
+constexpr char   IMAGECACHE_EXTENSION[]       = ".img";
+constexpr char   IMAGECACHE_ETC2_EXTENSION[]  = ".etc2";
+constexpr char   IMAGECACHE_THUMB_EXTENSION[] = ".thumb";
+constexpr int    IMAGECACHE_THUMB_SIZE        = 32;
+
+struct SImageCacheHeader {
+    char     magic[8];
+    uint32_t width     = 0;
+    uint32_t height    = 0;
+    uint32_t keyLength = 0;
+    // mip levels of compressed entries, 0 otherwise
+    uint32_t levels    = 0;
+};
+
+CImageCache::CMapping::CMapping(void* data, size_t len, const uint8_t* pixels_, const Vector2D& size_) : pixels(pixels_), size(size_), m_data(data), m_len(len) {
+    ;
+}
+
+CImageCache::CMapping::~CMapping() {
+    munmap(m_data, m_len);
+}
+
+std::filesystem::path CImageCache::pathFor(const std::string& source, const char* extension) {
+    const auto DIR = cacheDirectory();
+    if (DIR.empty())
+        return {};
+
+    return DIR / std::format("{:016x}{}", fnv1a(source), extension);
+}
+
+SP<CImageCache::CMapping> CImageCache::map(const std::filesystem::path& path, const char (&magic)[8], std::string& key) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SImageCacheHeader)) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    SImageCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    size_t PIXELLEN = 0;
+    if (header.levels == 0)
+        PIXELLEN = (size_t)header.width * header.height * 4;
+    else {
+        for (uint32_t i = 0, w = header.width, h = header.height; i < header.levels; ++i, w = std::max(1u, w / 2), h = std::max(1u, h / 2)) {
+            PIXELLEN += CTextureCompressor::etc2Size(w, h);
+        }
+    }
+
+    const auto* KEYPTR = (const char*)data + sizeof(header);
+
+    // a hash collision or a truncated write just means a miss
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || (size_t)st.st_size != sizeof(header) + header.keyLength + PIXELLEN ||
+        (!key.empty() && (header.keyLength != key.size() || std::memcmp(KEYPTR, key.data(), key.size()) != 0))) {
+        Debug::log(WARN, "Image cache: ignoring stale or corrupt entry {}", path.string());
+        munmap(data, st.st_size);
+        return nullptr;
+    }
+
+    if (key.empty())
+        key.assign(KEYPTR, header.keyLength);
+
+    auto mapping = makeShared<CMapping>(data, st.st_size, (const uint8_t*)KEYPTR + header.keyLength, Vector2D{(double)header.width, (double)header.height});
+    mapping->compressedLevels = header.levels;
+
+    return mapping;
+}
+
+SP<CImageCache::CMapping> CImageCache::load(const std::string& source) {
+    if (source.empty())
+        return nullptr;
+
+    const auto PATH = pathFor(source, IMAGECACHE_EXTENSION);
+    if (PATH.empty())
+        return nullptr;
+
+    std::string key     = source;
+    auto        mapping = map(PATH, IMAGECACHE_MAGIC, key);
+    if (mapping)
+        Debug::log(LOG, "Image cache: mapped {}x{} from {}", mapping->size.x, mapping->size.y, PATH.string());
+
+    return mapping;
+}
+
+SP<CImageCache::CMapping> CImageCache::loadCompressed(const std::string& source) {
+    if (source.empty())
+        return nullptr;
+
+    const auto PATH = pathFor(source, IMAGECACHE_ETC2_EXTENSION);
+    if (PATH.empty())
+        return nullptr;
+
+    std::string key     = source;
+    auto        mapping = map(PATH, IMAGECACHE_ETC2_MAGIC, key);
+    if (mapping)
+        Debug::log(LOG, "Image cache: mapped ETC2 {}x{} ({} levels) from {}", mapping->size.x, mapping->size.y, mapping->compressedLevels, PATH.string());
+
+    return mapping;
+}
+
+bool CImageCache::write(const std::filesystem::path& path, const char (&magic)[8], const std::string& key, const Vector2D& size, uint32_t levels,
+                        const std::function<bool(std::ofstream&)>& writePixels) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        Debug::log(ERR, "Image cache: failed to create {}: {}", path.parent_path().string(), ec.message());
+        return false;
+    }
+
+    SImageCacheHeader header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.width     = size.x;
+    header.height    = size.y;
+    header.keyLength = key.size();
+    header.levels    = levels;
+
+    // write-then-rename, so a reader never sees a half-written file. The tid keeps parallel decoders apart.
+    const auto TMPPATH = std::filesystem::path(path.string() + std::format(".{}.{}.tmp", getpid(), gettid()));
+    {
+        std::ofstream ofs(TMPPATH, std::ios::binary | std::ios::trunc);
+        ofs.write((const char*)&header, sizeof(header));
+        ofs.write(key.data(), key.size());
+
+        if (!writePixels(ofs) || !ofs.good()) {
+            Debug::log(ERR, "Image cache: failed to write {}", TMPPATH.string());
+            ofs.close();
+            std::filesystem::remove(TMPPATH, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(TMPPATH, path, ec);
+    if (ec) {
+        Debug::log(ERR, "Image cache: failed to rename {}: {}", TMPPATH.string(), ec.message());
+        std::filesystem::remove(TMPPATH, ec);
+        return false;
+    }
+
+    Debug::log(LOG, "Image cache: wrote {}", path.string());
+
+    pruneCacheFiles(path.parent_path(), path.extension().string(), IMAGECACHE_MAXFILES);
+    return true;
+}
+
+void CImageCache::store(const std::string& source, cairo_surface_t* surface) {
+    if (source.empty() || cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32)
+        return;
+
+    const auto PATH = pathFor(source, IMAGECACHE_EXTENSION);
+    if (PATH.empty())
+        return;
+
+    cairo_surface_flush(surface);
+
+    const int   WIDTH  = cairo_image_surface_get_width(surface);
+    const int   HEIGHT = cairo_image_surface_get_height(surface);
+    const int   STRIDE = cairo_image_surface_get_stride(surface);
+    const auto* DATA   = (const char*)cairo_image_surface_get_data(surface);
+
+    if (!DATA || WIDTH <= 0 || HEIGHT <= 0)
+        return;
+
+    write(PATH, IMAGECACHE_MAGIC, source, {(double)WIDTH, (double)HEIGHT}, 0, [&](std::ofstream& ofs) {
+        // rows are stored tightly packed
+        for (int y = 0; y < HEIGHT; ++y) {
+            ofs.write(DATA + (size_t)y * STRIDE, (size_t)WIDTH * 4);
+        }
+        return true;
+    });
+}
+
+SP<CImageCache::CMapping> CImageCache::loadThumbnail(const std::string& source) {
+    if (source.empty())
+        return nullptr;
+
+    const auto PATH = pathFor(source, IMAGECACHE_THUMB_EXTENSION);
+    if (PATH.empty())
+        return nullptr;
+
+    std::string key = source;
+    return map(PATH, IMAGECACHE_THUMB_MAGIC, key);
+}
+
+void CImageCache::storeThumbnail(const std::string& source, cairo_surface_t* surface) {
+    if (source.empty() || cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32)
+        return;
+
+    const int    WIDTH  = cairo_image_surface_get_width(surface);
+    const int    HEIGHT = cairo_image_surface_get_height(surface);
+    const double SCALE  = std::min(1.0, (double)IMAGECACHE_THUMB_SIZE / std::max({WIDTH, HEIGHT, 1}));
+    const int    TW     = std::max(1, (int)std::round(WIDTH * SCALE));
+    const int    TH     = std::max(1, (int)std::round(HEIGHT * SCALE));
+
+    auto         thumb = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TW, TH);
+    auto         cairo = cairo_create(thumb);
+    cairo_scale(cairo, (double)TW / WIDTH, (double)TH / HEIGHT);
+    cairo_set_source_surface(cairo, surface, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cairo), CAIRO_FILTER_GOOD);
+    cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cairo);
+    cairo_destroy(cairo);
+    cairo_surface_flush(thumb);
+
+    // a 3x3 box blur, so that bilinear upscaling by GL looks smooth rather than blocky
+    const int            STRIDE = cairo_image_surface_get_stride(thumb);
+    const auto*          DATA   = cairo_image_surface_get_data(thumb);
+    std::vector<uint8_t> blurred((size_t)TW * TH * 4);
+    for (int y = 0; y < TH; ++y) {
+        for (int x = 0; x < TW; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                int sum = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        sum += DATA[std::clamp(y + dy, 0, TH - 1) * STRIDE + std::clamp(x + dx, 0, TW - 1) * 4 + c];
+                    }
+                }
+                blurred[((size_t)y * TW + x) * 4 + c] = (sum + 4) / 9;
+            }
+        }
+    }
+
+    cairo_surface_destroy(thumb);
+
+    write(pathFor(source, IMAGECACHE_THUMB_EXTENSION), IMAGECACHE_THUMB_MAGIC, source, {(double)TW, (double)TH}, 0, [&](std::ofstream& ofs) {
+        ofs.write((const char*)blurred.data(), blurred.size());
+        return true;
+    });
+}
+
+bool CImageCache::precompile() {
+    const auto DIR = cacheDirectory();
+    if (DIR.empty()) {
+        Debug::log(ERR, "Precompile: no cache directory");
+        return false;
+    }
+
+    std::vector<std::filesystem::path> entries;
+    std::error_code                    ec;
+    for (const auto& entry : std::filesystem::directory_iterator(DIR, ec)) {
+        if (entry.path().extension() == IMAGECACHE_EXTENSION)
+            entries.push_back(entry.path());
+    }
+
+    if (entries.empty()) {
+        Debug::log(WARN, "Precompile: nothing decoded in {} yet, lock once so the images get cached at the size they are shown at", DIR.string());
+        return false;
+    }
+
+    size_t written = 0;
+    for (const auto& path : entries) {
+        std::string key;
+        const auto  MAPPING = map(path, IMAGECACHE_MAGIC, key);
+        if (!MAPPING)
+            continue;
+
+        // the key is the source id and the decoded size, the image might have changed since
+        const auto SOURCE = key.substr(0, key.rfind('@'));
+        const auto ID     = SOURCE.substr(0, SOURCE.rfind(':', SOURCE.rfind(':') - 1));
+        if (CBlurCache::sourceID(ID) != SOURCE) {
+            Debug::log(LOG, "Precompile: skipping {}, the image changed", ID);
+            continue;
+        }
+
+        if (loadCompressed(key)) {
+            Debug::log(LOG, "Precompile: {} is up to date", ID);
+            written++;
+            continue;
+        }
+
+        const int WIDTH  = MAPPING->size.x;
+        const int HEIGHT = MAPPING->size.y;
+
+        // ETC2 RGB8 has no alpha, translucent images keep using the uncompressed entry
+        bool opaque = true;
+        for (size_t i = 3; i < (size_t)WIDTH * HEIGHT * 4 && opaque; i += 4) {
+            opaque = MAPPING->pixels[i] == 0xFF;
+        }
+
+        if (!opaque) {
+            Debug::log(LOG, "Precompile: skipping {}, it has transparency", ID);
+            continue;
+        }
+
+        uint32_t   levels  = 0;
+        const auto ENCODED = CTextureCompressor::encodeETC2(MAPPING->pixels, WIDTH, HEIGHT, (size_t)WIDTH * 4, levels);
+
+        if (write(pathFor(key, IMAGECACHE_ETC2_EXTENSION), IMAGECACHE_ETC2_MAGIC, key, MAPPING->size, levels, [&](std::ofstream& ofs) {
+                ofs.write((const char*)ENCODED.data(), ENCODED.size());
+                return true;
+            })) {
+            Debug::log(LOG, "Precompile: encoded {} at {}x{}, {} KiB", ID, WIDTH, HEIGHT, ENCODED.size() / 1024);
+            written++;
+        }
+    }
+
+    return written > 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../helpers/Math.hpp"
+#include <cairo/cairo.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+
+// Decoded images, so that a warm start maps the pixels of a wallpaper instead of decoding it again.
+// Entries are keyed like the blur cache (path, mtime, size) and hold cairo ARGB32 pixels,
+// i.e. premultiplied BGRA in memory, behind a small header.
+// mpvlock --precompile-assets adds ETC2 compressed variants of opaque entries next to them, and backgrounds get a thumbnail.
+class CImageCache {
+  public:
+    // read-only view of a cache entry, unmapped once the last reference is gone
+    class CMapping {
+      public:
+        CMapping(void* data, size_t len, const uint8_t* pixels, const Vector2D& size);
+        ~CMapping();
+
+        const uint8_t* pixels = nullptr;
+        Vector2D       size;
+        // ETC2 levels one after another if set, see CTextureCompressor
+        uint32_t       compressedLevels = 0;
+
+      private:
+        void*  m_data = nullptr;
+        size_t m_len  = 0;
+    };
+
+    // nullptr on a miss
+    static SP<CMapping>          load(const std::string& source);
+    static SP<CMapping>          loadCompressed(const std::string& source);
+    // only ARGB32 surfaces are cached. Writes synchronously, so call it from a decoder thread.
+    static void                  store(const std::string& source, cairo_surface_t* surface);
+
+    // a blurred preview of at most 32px a side, for the first frame of the next lock. Keyed by the source alone.
+    static SP<CMapping>          loadThumbnail(const std::string& source);
+    static void                  storeThumbnail(const std::string& source, cairo_surface_t* surface);
+
+    // encodes every up-to-date opaque entry that has no compressed variant yet. False if none could be written.
+    static bool                  precompile();
+
+  private:
+    static std::filesystem::path pathFor(const std::string& source, const char* extension);
+    // checks the header and the key, an empty key accepts any and returns it
+    static SP<CMapping>          map(const std::filesystem::path& path, const char (&magic)[8], std::string& key);
+    static bool                  write(const std::filesystem::path& path, const char (&magic)[8], const std::string& key, const Vector2D& size, uint32_t levels,
+                                       const std::function<bool(std::ofstream&)>& writePixels);
+};
@@ -0,0 +1,217 @@
+#include "ImageDecoder.hpp"
+#include "../helpers/Log.hpp"
+#include <hyprgraphics/image/Image.hpp>
+#include <algorithm>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <jpeglib.h>
+#include <webp/decode.h>
+
+using namespace Hyprgraphics;
+
+// <= 1, the factor that still covers coverSize
+static double coverScale(const Vector2D& imageSize, const Vector2D& coverSize) {
+    if (coverSize.x <= 0 || coverSize.y <= 0 || imageSize.x <= 0 || imageSize.y <= 0)
+        return 1.0;
+
+    return std::min(1.0, std::max(coverSize.x / imageSize.x, coverSize.y / imageSize.y));
+}
+
+static bool readMagic(const std::filesystem::path& path, unsigned char (&magic)[12]) {
+    std::ifstream ifs(path, std::ios::binary);
+    return ifs.read((char*)magic, sizeof(magic)).good();
+}
+
+SP<CCairoSurface> CImageDecoder::decode(const std::filesystem::path& path, const Vector2D& coverSize) {
+    unsigned char    magic[12] = {0};
+    cairo_surface_t* scaled    = nullptr;
+
+    if (coverSize.x > 0 && coverSize.y > 0 && readMagic(path, magic)) {
+        if (magic[0] == 0xFF && magic[1] == 0xD8 && magic[2] == 0xFF)
+            scaled = decodeJPEG(path, coverSize);
+        else if (std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "WEBP", 4) == 0)
+            scaled = decodeWebP(path, coverSize);
+    }
+
+    if (scaled)
+        return makeShared<CCairoSurface>(scaled);
+
+    // anything the scaling decoders can't handle (CMYK JPEGs, animated WebPs, other formats) takes the generic path
+    auto image = CImage(path);
+    if (!image.success()) {
+        Debug::log(ERR, "Image {} could not be loaded: {}", path.string(), image.getError());
+        return nullptr;
+    }
+
+    return downscale(image.cairoSurface(), coverSize);
+}
+
+#ifdef JCS_EXTENSIONS
+struct SJPEGError {
+    jpeg_error_mgr mgr;
+    jmp_buf        jump;
+};
+
+static void onJPEGError(j_common_ptr info) {
+    char message[JMSG_LENGTH_MAX];
+    info->err->format_message(info, message);
+    Debug::log(WARN, "JPEG decode: {}", message);
+    longjmp(((SJPEGError*)info->err)->jump, 1);
+}
+#endif
+
+cairo_surface_t* CImageDecoder::decodeJPEG(const std::filesystem::path& path, const Vector2D& coverSize) {
+#ifdef JCS_EXTENSIONS
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return nullptr;
+
+    jpeg_decompress_struct    cinfo;
+    SJPEGError                error;
+    cairo_surface_t* volatile surface = nullptr;
+
+    cinfo.err              = jpeg_std_error(&error.mgr);
+    error.mgr.error_exit   = onJPEGError;
+    error.mgr.emit_message = [](j_common_ptr, int) {};
+
+    // no objects with destructors may live between here and the longjmp
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        fclose(file);
+        if (surface)
+            cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_stdio_src(&cinfo, file);
+    jpeg_read_header(&cinfo, TRUE);
+
+    // libjpeg-turbo scales by M/8 while decoding, pick the smallest M that still covers
+    const double SCALE = coverScale(Vector2D{(double)cinfo.image_width, (double)cinfo.image_height}, coverSize);
+    int          num   = 8;
+    while (num > 1 && (num - 1) / 8.0 >= SCALE) {
+        num--;
+    }
+
+    cinfo.scale_num   = num;
+    cinfo.scale_denom = 8;
+    // cairo's ARGB32 in memory. The padding byte is written as 0xFF, so opaque.
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    cinfo.out_color_space = JCS_EXT_BGRA;
+#else
+    cinfo.out_color_space = JCS_EXT_ARGB;
+#endif
+
+    jpeg_start_decompress(&cinfo);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, cinfo.output_width, cinfo.output_height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        longjmp(error.jump, 1);
+
+    unsigned char* data   = cairo_image_surface_get_data(surface);
+    const int      STRIDE = cairo_image_surface_get_stride(surface);
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = data + (size_t)cinfo.output_scanline * STRIDE;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    fclose(file);
+
+    cairo_surface_mark_dirty(surface);
+
+    Debug::log(LOG, "JPEG decode: {} at {}/8 ({}x{})", path.string(), num, cinfo.output_width, cinfo.output_height);
+
+    return surface;
+#else
+    return nullptr;
+#endif
+}
+
+cairo_surface_t* CImageDecoder::decodeWebP(const std::filesystem::path& path, const Vector2D& coverSize) {
+    std::ifstream              ifs(path, std::ios::binary);
+    const std::vector<uint8_t> BYTES{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+
+    WebPDecoderConfig          config;
+    if (!WebPInitDecoderConfig(&config) || WebPGetFeatures(BYTES.data(), BYTES.size(), &config.input) != VP8_STATUS_OK || config.input.has_animation)
+        return nullptr;
+
+    const double SCALE  = coverScale(Vector2D{(double)config.input.width, (double)config.input.height}, coverSize);
+    const int    WIDTH  = std::max(1, (int)std::ceil(config.input.width * SCALE));
+    const int    HEIGHT = std::max(1, (int)std::ceil(config.input.height * SCALE));
+
+    if (SCALE < 1.0) {
+        config.options.use_scaling   = 1;
+        config.options.scaled_width  = WIDTH;
+        config.options.scaled_height = HEIGHT;
+    }
+
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    // decode straight into the surface, premultiplied like cairo wants it
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    config.output.colorspace = MODE_bgrA;
+#else
+    config.output.colorspace = MODE_Argb;
+#endif
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba        = cairo_image_surface_get_data(surface);
+    config.output.u.RGBA.stride      = cairo_image_surface_get_stride(surface);
+    config.output.u.RGBA.size        = (size_t)config.output.u.RGBA.stride * HEIGHT;
+
+    const auto STATUS = WebPDecode(BYTES.data(), BYTES.size(), &config);
+    WebPFreeDecBuffer(&config.output);
+
+    if (STATUS != VP8_STATUS_OK) {
+        Debug::log(WARN, "WebP decode: {} failed ({})", path.string(), (int)STATUS);
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    cairo_surface_mark_dirty(surface);
+
+    Debug::log(LOG, "WebP decode: {} at {}x{}", path.string(), WIDTH, HEIGHT);
+
+    return surface;
+}
+
+SP<CCairoSurface> CImageDecoder::downscale(const SP<CCairoSurface>& surface, const Vector2D& coverSize) {
+    const auto FORMAT = cairo_image_surface_get_format(surface->cairo());
+    const auto SIZE   = surface->size();
+    const auto SCALE  = coverScale(SIZE, coverSize);
+
+    // float surfaces are left alone, cairo can't paint into them
+    if (SCALE >= 1.0 || (FORMAT != CAIRO_FORMAT_ARGB32 && FORMAT != CAIRO_FORMAT_RGB24))
+        return surface;
+
+    const int WIDTH  = std::max(1, (int)std::ceil(SIZE.x * SCALE));
+    const int HEIGHT = std::max(1, (int)std::ceil(SIZE.y * SCALE));
+
+    auto      scaled = makeShared<CCairoSurface>(cairo_image_surface_create(FORMAT, WIDTH, HEIGHT));
+    auto      cairo  = cairo_create(scaled->cairo());
+
+    cairo_scale(cairo, WIDTH / SIZE.x, HEIGHT / SIZE.y);
+    cairo_set_source_surface(cairo, surface->cairo(), 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cairo), CAIRO_FILTER_GOOD);
+    cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cairo);
+    cairo_destroy(cairo);
+
+    cairo_surface_flush(scaled->cairo());
+
+    Debug::log(LOG, "Image decode: downscaled {}x{} to {}x{}", SIZE.x, SIZE.y, WIDTH, HEIGHT);
+
+    return scaled;
+}
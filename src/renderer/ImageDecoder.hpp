@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../helpers/Math.hpp"
+#include <filesystem>
+#include <hyprgraphics/cairo/CairoSurface.hpp>
+
+// Decodes images no larger than needed to cover a given size, so an 8000x6000 photo on a 1080p output
+// is neither fully decoded nor uploaded. JPEG uses libjpeg's DCT scaling and WebP its scaling decoder,
+// everything else is decoded by hyprgraphics and downscaled afterwards. Safe to call from any thread.
+class CImageDecoder {
+  public:
+    // an empty coverSize decodes at full size
+    static SP<Hyprgraphics::CCairoSurface> decode(const std::filesystem::path& path, const Vector2D& coverSize);
+
+  private:
+    static cairo_surface_t*                decodeJPEG(const std::filesystem::path& path, const Vector2D& coverSize);
+    static cairo_surface_t*                decodeWebP(const std::filesystem::path& path, const Vector2D& coverSize);
+    static SP<Hyprgraphics::CCairoSurface> downscale(const SP<Hyprgraphics::CCairoSurface>& surface, const Vector2D& coverSize);
+};
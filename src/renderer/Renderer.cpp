@@ -17,6 +17,7 @@
 #include <GLES3/gl3ext.h>
 #include <GLES2/gl2ext.h>
 #include <algorithm>
+#include <cmath>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -34,6 +35,9 @@ inline const float fullVerts[] = {
     0, 1, // bottom left
 };
 
+// enough for the RGBA16F blur mip chains of a 4K output and a couple of smaller ones
+constexpr size_t FBPOOL_MAX_IDLE_BYTES = 256 * 1024 * 1024;
+
 GLuint compileShader(const GLuint& type, std::string src) {
     try {
         auto shader = glCreateShader(type);
@@ -219,6 +223,18 @@ CRenderer::CRenderer() {
         borderShader.gradientLerp = glGetUniformLocation(prog, "gradientLerp");
         borderShader.alpha = glGetUniformLocation(prog, "alpha");
 
+        prog = createProgram(GLYPHVERTSRC, GLYPHFRAGSRC);
+        glyphShader.program = prog;
+        glyphShader.proj = glGetUniformLocation(prog, "proj");
+        glyphShader.tex = glGetUniformLocation(prog, "tex");
+        glyphShader.alpha = glGetUniformLocation(prog, "alpha");
+        glyphShader.posAttrib = glGetAttribLocation(prog, "pos");
+        glyphShader.texAttrib = glGetAttribLocation(prog, "texcoord");
+        glyphShader.colorAttrib = glGetAttribLocation(prog, "colorAttrib");
+
+        blurCache             = makeUnique<CBlurCache>();
+        glyphAtlas            = makeUnique<CGlyphAtlas>();
+        fbPool                = makeUnique<CFramebufferPool>(FBPOOL_MAX_IDLE_BYTES);
         asyncResourceGatherer = makeUnique<CAsyncResourceGatherer>();
         g_pAnimationManager->createAnimation(0.f, opacity, g_pConfigManager->m_AnimationTree.getConfig("fadeIn"));
     } catch (const std::exception& e) {
@@ -277,7 +293,36 @@ void CRenderer::renderInputFields(const CSessionLockSurface& surf, float opacity
     }
 }
 
-CRenderer::SRenderFeedback CRenderer::renderLock(const CSessionLockSurface& surf) {
+static void setScissorBox(const CBox& box) {
+    const auto ROUNDED = box.copy().round();
+    glScissor(ROUNDED.x, ROUNDED.y, std::max(0.0, ROUNDED.w), std::max(0.0, ROUNDED.h));
+}
+
+CRegion CRenderer::collectDamage(CSessionLockSurface& surf, const std::vector<SP<IWidget>>& widgets, bool full) {
+    const CBox SURFACEBOX = {0, 0, surf.size.x, surf.size.y};
+
+    CRegion    damage;
+    damage.set(surf.m_damage);
+    surf.m_damage.clear();
+
+    if (full || surf.m_bFullDamage) {
+        surf.m_bFullDamage = false;
+        return CRegion{SURFACEBOX};
+    }
+
+    // a changed widget needs both the area it covered before and the one it covers now
+    for (auto& w : widgets) {
+        if (!w->isDamaged())
+            continue;
+
+        damage.add(w->getLastDamageBox());
+        damage.add(w->getDamageBox());
+    }
+
+    return damage.intersect(CRegion{SURFACEBOX});
+}
+
+CRenderer::SRenderFeedback CRenderer::renderLock(CSessionLockSurface& surf) {
     try {
         projection = Mat3x3::outputProjection(surf.size, HYPRUTILS_TRANSFORM_NORMAL);
         g_pEGL->makeCurrent(surf.eglSurface);
@@ -287,22 +332,47 @@ CRenderer::SRenderFeedback CRenderer::renderLock(const CSessionLockSurface& surf
         glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fb);
         pushFb(fb);
 
+        SRenderFeedback feedback;
+        const bool      WAITFORASSETS = !g_pMpvlock->m_bImmediateRender && !asyncResourceGatherer->gathered;
+        const bool      NEWWIDGETS    = !widgets.contains(surf.m_outputID);
+        auto&           surfWidgets   = getOrCreateWidgetsFor(surf);
+
+        // the back buffer holds what we presented `age` frames ago, 0 means its contents are undefined
+        EGLint age = 0;
+        if (g_pEGL->m_bHasBufferAge)
+            eglQuerySurface(g_pEGL->eglDisplay, surf.eglSurface, EGL_BUFFER_AGE_EXT, &age);
+
+        const bool FULLDAMAGE = NEWWIDGETS || WAITFORASSETS || opacity->isBeingAnimated() || age <= 0 || age > (EGLint)surf.m_damageHistory.size() + 1;
+
+        feedback.damage = collectDamage(surf, surfWidgets, FULLDAMAGE);
+
+        CRegion repaint;
+        repaint.set(feedback.damage);
+        for (EGLint i = 0; !FULLDAMAGE && i < age - 1; ++i) {
+            repaint.add(surf.m_damageHistory[i]);
+        }
+
+        for (size_t i = surf.m_damageHistory.size() - 1; i > 0; --i) {
+            surf.m_damageHistory[i].set(surf.m_damageHistory[i - 1]);
+        }
+        surf.m_damageHistory[0].set(feedback.damage);
+
+        m_repaintBox = repaint.getExtents();
+        glEnable(GL_SCISSOR_TEST);
+        setScissorBox(*m_repaintBox);
+
         glClearColor(0.0, 0.0, 0.0, 0.0);
         glClear(GL_COLOR_BUFFER_BIT);
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-        SRenderFeedback feedback;
-        const bool WAITFORASSETS = !g_pMpvlock->m_bImmediateRender && !asyncResourceGatherer->gathered;
-
-        if (!WAITFORASSETS) {
+        if (!WAITFORASSETS && !repaint.empty()) {
             // Render all widgets in zindex order
-            auto widgets = getOrCreateWidgetsFor(surf);
             std::map<int, std::vector<SP<IWidget>>> zindexGroups;
 
             // Group widgets by zindex
-            for (auto& w : widgets) {
+            for (auto& w : surfWidgets) {
                 int zindex = w->getZindex();
                 zindexGroups[zindex].push_back(w);
             }
@@ -310,19 +380,39 @@ CRenderer::SRenderFeedback CRenderer::renderLock(const CSessionLockSurface& surf
             // Render in ascending zindex order
             for (const auto& [zindex, group] : zindexGroups) {
                 for (auto& w : group) {
-                    feedback.needsFrame = w->draw({opacity->value()}) || feedback.needsFrame;
+                    // untouched pixels of an unchanged widget are still valid in the back buffer
+                    if (!w->isDamaged() && w->getDamageBox().intersection(*m_repaintBox).empty())
+                        continue;
+
+                    const auto PREDICTED  = w->getDamageBox();
+                    const bool NEEDSFRAME = w->draw({opacity->value()});
+                    w->onDrawn(NEEDSFRAME);
+                    feedback.needsFrame = NEEDSFRAME || feedback.needsFrame;
+
+                    // the widget ended up larger than predicted, paint the rest with the next frame.
+                    // being clipped by the repaint box alone is fine, what's outside it is still valid
+                    const auto& DRAWN  = w->getLastDamageBox();
+                    const auto  INSIDE = DRAWN.intersection(PREDICTED);
+                    if (!DRAWN.empty() && (INSIDE.w < DRAWN.w || INSIDE.h < DRAWN.h)) {
+                        surf.damage(DRAWN);
+                        feedback.needsFrame = true;
+                    }
                 }
             }
         }
 
-        feedback.needsFrame = feedback.needsFrame || !asyncResourceGatherer->gathered;
 
         glDisable(GL_BLEND);
+        glDisable(GL_SCISSOR_TEST);
+        m_repaintBox.reset();
         popFb();
         return feedback;
     } catch (const std::exception& e) {
         Debug::log(ERR, "renderLock failed for output {}: {}", surf.m_outputRef.lock()->stringPort, e.what());
         glDisable(GL_BLEND);
+        glDisable(GL_SCISSOR_TEST);
+        m_repaintBox.reset();
+        surf.damageEntire();
         popFb();
         return {};
     }
@@ -430,6 +520,42 @@ void CRenderer::renderTexture(const CBox& box, const CTexture& tex, float a, int
     }
 }
 
+void CRenderer::renderGlyphs(const CBox& box, const CGlyphAtlas::SMesh& mesh, float a) {
+    try {
+        const auto ROUNDEDBOX = box.copy().round();
+        Mat3x3 matrix = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_FLIPPED_180, box.rot);
+        Mat3x3 glMatrix = projection.copy().multiply(matrix);
+
+        CShader* shader = &glyphShader;
+        glActiveTexture(GL_TEXTURE0);
+        glUseProgram(shader->program);
+        glUniformMatrix3fv(shader->proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+        glUniform1i(shader->tex, 0);
+        glUniform1f(shader->alpha, a);
+
+        glEnableVertexAttribArray(shader->posAttrib);
+        glEnableVertexAttribArray(shader->texAttrib);
+        glEnableVertexAttribArray(shader->colorAttrib);
+
+        // one draw per atlas page, a label rarely spans more than one
+        for (const auto& batch : mesh.batches) {
+            const GLsizei STRIDE = sizeof(CGlyphAtlas::SVertex);
+            glBindTexture(GL_TEXTURE_2D, batch.texture);
+            glVertexAttribPointer(shader->posAttrib, 2, GL_FLOAT, GL_FALSE, STRIDE, &batch.vertices[0].x);
+            glVertexAttribPointer(shader->texAttrib, 2, GL_FLOAT, GL_FALSE, STRIDE, &batch.vertices[0].u);
+            glVertexAttribPointer(shader->colorAttrib, 4, GL_FLOAT, GL_FALSE, STRIDE, &batch.vertices[0].r);
+            glDrawArrays(GL_TRIANGLES, 0, batch.vertices.size());
+        }
+
+        glDisableVertexAttribArray(shader->posAttrib);
+        glDisableVertexAttribArray(shader->texAttrib);
+        glDisableVertexAttribArray(shader->colorAttrib);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    } catch (const std::exception& e) {
+        Debug::log(ERR, "renderGlyphs failed: {}", e.what());
+    }
+}
+
 void CRenderer::renderTextureMix(const CBox& box, const CTexture& tex, const CTexture& tex2, float a, float mixFactor, int rounding, std::optional<eTransform> tr) {
     try {
         const auto ROUNDEDBOX = box.copy().round();
@@ -529,61 +655,37 @@ std::vector<SP<IWidget>>& CRenderer::getOrCreateWidgetsFor(const CSessionLockSur
 }
 
 void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
+    // dual kawase over a mip chain: level 0 is the working resolution, each down pass renders into a target of half the size
+    // and each up pass doubles back, so most of the work happens at a fraction of the output's size
+    std::vector<SP<CFramebuffer>> levels;
+
     try {
         glDisable(GL_BLEND);
         glDisable(GL_STENCIL_TEST);
 
         CBox box{0, 0, outfb.m_vSize.x, outfb.m_vSize.y};
         box.round();
-        Mat3x3 matrix = projMatrix.projectBox(box, HYPRUTILS_TRANSFORM_NORMAL, 0);
-        Mat3x3 glMatrix = projection.copy().multiply(matrix);
-
-        CFramebuffer mirrors[2];
-        mirrors[0].alloc(outfb.m_vSize.x, outfb.m_vSize.y, true);
-        mirrors[1].alloc(outfb.m_vSize.x, outfb.m_vSize.y, true);
+        Mat3x3     matrix   = projMatrix.projectBox(box, HYPRUTILS_TRANSFORM_NORMAL, 0);
+        Mat3x3     glMatrix = projection.copy().multiply(matrix);
 
-        CFramebuffer* currentRenderToFB = &mirrors[0];
+        const auto SCALE  = std::clamp(params.scale, 0.05f, 1.f);
+        const int  PASSES = std::max(params.passes, 0);
+        const int  WORKW  = std::max(1, (int)std::round(outfb.m_vSize.x * SCALE));
+        const int  WORKH  = std::max(1, (int)std::round(outfb.m_vSize.y * SCALE));
 
-        {
-            mirrors[1].bind();
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(outfb.m_cTex.m_iTarget, outfb.m_cTex.m_iTexID);
-            glTexParameteri(outfb.m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glUseProgram(blurPrepareShader.program);
-            glUniformMatrix3fv(blurPrepareShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-            glUniform1f(blurPrepareShader.contrast, params.contrast);
-            glUniform1f(blurPrepareShader.brightness, params.brightness);
-            glUniform1i(blurPrepareShader.tex, 0);
-            glVertexAttribPointer(blurPrepareShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-            glEnableVertexAttribArray(blurPrepareShader.posAttrib);
-            glVertexAttribPointer(blurPrepareShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-            glEnableVertexAttribArray(blurPrepareShader.texAttrib);
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            glDisableVertexAttribArray(blurPrepareShader.posAttrib);
-            glDisableVertexAttribArray(blurPrepareShader.texAttrib);
-            currentRenderToFB = &mirrors[1];
+        for (int i = 0; i <= PASSES; ++i) {
+            levels.emplace_back(fbPool->acquire(std::max(1, WORKW >> i), std::max(1, WORKH >> i), true));
         }
 
-        auto drawPass = [&](CShader* pShader) {
-            if (currentRenderToFB == &mirrors[0])
-                mirrors[1].bind();
-            else
-                mirrors[0].bind();
-            glActiveTexture(GL_TEXTURE0); // Fixed from GL_TEXTURE FactoryBot: _0
-            glBindTexture(currentRenderToFB->m_cTex.m_iTarget, currentRenderToFB->m_cTex.m_iTexID);
-            glTexParameteri(currentRenderToFB->m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        auto drawPass = [&](CShader* pShader, const CTexture& source, const CFramebuffer& target, auto&& setUniforms) {
+            target.bind();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(source.m_iTarget, source.m_iTexID);
+            glTexParameteri(source.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glUseProgram(pShader->program);
             glUniformMatrix3fv(pShader->proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-            glUniform1f(pShader->radius, params.size);
-            if (pShader == &blurShader1) {
-                glUniform2f(blurShader1.halfpixel, 0.5f / (outfb.m_vSize.x / 2.f), 0.5f / (outfb.m_vSize.y / 2.f));
-                glUniform1i(blurShader1.passes, params.passes);
-                glUniform1f(blurShader1.vibrancy, params.vibrancy);
-                glUniform1f(blurShader1.vibrancy_darkness, params.vibrancy_darkness);
-            } else {
-                glUniform2f(blurShader2.halfpixel, 0.5f / (outfb.m_vSize.x * 2.f), 0.5f / (outfb.m_vSize.y * 2.f));
-            }
             glUniform1i(pShader->tex, 0);
+            setUniforms();
             glVertexAttribPointer(pShader->posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
             glEnableVertexAttribArray(pShader->posAttrib);
             glVertexAttribPointer(pShader->texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
@@ -591,59 +693,75 @@ void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
             glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
             glDisableVertexAttribArray(pShader->posAttrib);
             glDisableVertexAttribArray(pShader->texAttrib);
-            currentRenderToFB = (currentRenderToFB == &mirrors[0]) ? &mirrors[1] : &mirrors[0];
         };
 
-        mirrors[0].bind();
-        glBindTexture(mirrors[1].m_cTex.m_iTarget, mirrors[1].m_cTex.m_iTexID);
-        for (int i = 1; i <= params.passes; ++i) {
-            drawPass(&blurShader1);
+        // also scales down to the working resolution
+        drawPass(&blurPrepareShader, outfb.m_cTex, *levels[0], [&]() {
+            glUniform1f(blurPrepareShader.contrast, params.contrast);
+            glUniform1f(blurPrepareShader.brightness, params.brightness);
+        });
+
+        for (int i = 1; i <= PASSES; ++i) {
+            drawPass(&blurShader1, levels[i - 1]->m_cTex, *levels[i], [&]() {
+                glUniform1f(blurShader1.radius, params.size);
+                glUniform2f(blurShader1.halfpixel, 0.5f / levels[i]->m_vSize.x, 0.5f / levels[i]->m_vSize.y);
+                glUniform1i(blurShader1.passes, params.passes);
+                glUniform1f(blurShader1.vibrancy, params.vibrancy);
+                glUniform1f(blurShader1.vibrancy_darkness, params.vibrancy_darkness);
+            });
         }
-        for (int i = params.passes - 1; i >= 0; --i) {
-            drawPass(&blurShader2);
+
+        for (int i = PASSES - 1; i >= 0; --i) {
+            drawPass(&blurShader2, levels[i + 1]->m_cTex, *levels[i], [&]() {
+                glUniform1f(blurShader2.radius, params.size);
+                glUniform2f(blurShader2.halfpixel, 0.5f / levels[i]->m_vSize.x, 0.5f / levels[i]->m_vSize.y);
+            });
         }
 
-        {
-            if (currentRenderToFB == &mirrors[0])
-                mirrors[1].bind();
-            else
-                mirrors[0].bind();
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(currentRenderToFB->m_cTex.m_iTarget, currentRenderToFB->m_cTex.m_iTexID);
-            glTexParameteri(currentRenderToFB->m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glUseProgram(blurFinishShader.program);
-            glUniformMatrix3fv(blurFinishShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+        // scales back up into outfb
+        drawPass(&blurFinishShader, levels[0]->m_cTex, outfb, [&]() {
             glUniform1f(blurFinishShader.noise, params.noise);
             glUniform1f(blurFinishShader.brightness, params.brightness);
             glUniform1i(blurFinishShader.colorize, params.colorize.has_value());
             if (params.colorize.has_value())
                 glUniform3f(blurFinishShader.colorizeTint, params.colorize->r, params.colorize->g, params.colorize->b);
             glUniform1f(blurFinishShader.boostA, params.boostA);
-            glUniform1i(blurFinishShader.tex, 0);
-            glVertexAttribPointer(blurFinishShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-            glEnableVertexAttribArray(blurFinishShader.posAttrib);
-            glVertexAttribPointer(blurFinishShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-            glEnableVertexAttribArray(blurFinishShader.texAttrib);
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            glDisableVertexAttribArray(blurFinishShader.posAttrib);
-            glDisableVertexAttribArray(blurFinishShader.texAttrib);
-            currentRenderToFB = (currentRenderToFB == &mirrors[0]) ? &mirrors[1] : &mirrors[0];
-        }
+        });
 
-        outfb.bind();
-        renderTexture(box, currentRenderToFB->m_cTex, 1.0, 0, HYPRUTILS_TRANSFORM_NORMAL);
         glEnable(GL_BLEND);
     } catch (const std::exception& e) {
         Debug::log(ERR, "blurFB failed: {}", e.what());
         outfb.bind();
         glEnable(GL_BLEND);
     }
+
+    for (const auto& level : levels) {
+        fbPool->release(level, true);
+    }
+}
+
+void CRenderer::scissor(const CBox& box) {
+    // offscreen passes don't care about the lock surface's damage
+    const bool ONSURFACE = m_repaintBox.has_value() && boundFBs.size() == 1;
+
+    glEnable(GL_SCISSOR_TEST);
+    setScissorBox(ONSURFACE ? box.intersection(*m_repaintBox) : box);
+}
+
+void CRenderer::unscissor() {
+    if (m_repaintBox.has_value() && boundFBs.size() == 1)
+        setScissorBox(*m_repaintBox);
+    else
+        glDisable(GL_SCISSOR_TEST);
 }
 
 void CRenderer::pushFb(GLint fb) {
     try {
         boundFBs.push_back(fb);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb);
+
+        if (boundFBs.size() > 1)
+            glDisable(GL_SCISSOR_TEST);
     } catch (const std::exception& e) {
         Debug::log(ERR, "pushFb failed: {}", e.what());
     }
@@ -654,6 +772,12 @@ void CRenderer::popFb() {
         if (!boundFBs.empty()) {
             boundFBs.pop_back();
             glBindFramebuffer(GL_DRAW_FRAMEBUFFER, boundFBs.empty() ? 0 : boundFBs.back());
+
+            // back on the lock surface, restore the clip to this frame's repaint area
+            if (boundFBs.size() == 1 && m_repaintBox.has_value()) {
+                glEnable(GL_SCISSOR_TEST);
+                setScissorBox(*m_repaintBox);
+            }
         }
     } catch (const std::exception& e) {
         Debug::log(ERR, "popFb failed: {}", e.what());
@@ -663,6 +787,8 @@ void CRenderer::popFb() {
 void CRenderer::removeWidgetsFor(OUTPUTID id) {
     try {
         widgets.erase(id);
+        // the output's size might not come back, don't keep its scratch framebuffers around
+        fbPool->clear();
         Debug::log(LOG, "Removed widgets for output ID {}", id);
     } catch (const std::exception& e) {
         Debug::log(ERR, "removeWidgetsFor failed for ID {}: {}", id, e.what());
@@ -732,6 +858,10 @@ bool CRenderer::startMpvpaper(const std::string& monitor, const std::string& pat
             if (freopen(logFile.c_str(), "w", stderr) == nullptr) {
                 Debug::log(ERR, "Failed to redirect stderr to {}: errno {}", logFile, errno);
             }
+            // the signal mask survives exec, don't pass on the signals the event loop blocked for itself
+            sigset_t signals;
+            sigemptyset(&signals);
+            sigprocmask(SIG_SETMASK, &signals, nullptr);
             execvp("mpvpaper", argv.data());
             Debug::log(ERR, "execvp failed for mpvpaper on monitor {} with video {}: errno {}", monitor, path, errno);
             _exit(1);
@@ -9,6 +9,9 @@
 #include "../helpers/AnimatedVariable.hpp"
 #include "../helpers/Color.hpp"
 #include "AsyncResourceGatherer.hpp"
+#include "BlurCache.hpp"
+#include "GlyphAtlas.hpp"
+#include "FramebufferPool.hpp"
 #include "../config/ConfigDataValues.hpp"
 #include "widgets/IWidget.hpp"
 #include "Framebuffer.hpp"
@@ -24,7 +27,9 @@ class CRenderer {
     CRenderer();
 
     struct SRenderFeedback {
-        bool needsFrame = false;
+        bool    needsFrame = false;
+        // what changed on the surface with this frame, in GL (bottom-left origin) coordinates
+        CRegion damage;
     };
 
     struct SBlurParams {
@@ -32,23 +37,34 @@ class CRenderer {
         float                     noise = 0, contrast = 0, brightness = 0, vibrancy = 0, vibrancy_darkness = 0;
         std::optional<CHyprColor> colorize;
         float                     boostA = 1.0;
+        // working resolution relative to the framebuffer, lower is cheaper and blurrier
+        float                     scale = 1.0;
     };
 
-    SRenderFeedback renderLock(const CSessionLockSurface& surf);
+    SRenderFeedback renderLock(CSessionLockSurface& surf);
 
     void            renderRect(const CBox& box, const CHyprColor& col, int rounding = 0);
     void            renderBorder(const CBox& box, const CGradientValueData& gradient, int thickness, int rounding = 0, float alpha = 1.0);
     void            renderTexture(const CBox& box, const CTexture& tex, float a = 1.0, int rounding = 0, std::optional<eTransform> tr = {});
     void            renderTextureMix(const CBox& box, const CTexture& tex, const CTexture& tex2, float a = 1.0, float mixFactor = 0.0, int rounding = 0, std::optional<eTransform> tr = {});
+    // quads from the glyph atlas, box is the text's logical extents
+    void            renderGlyphs(const CBox& box, const CGlyphAtlas::SMesh& mesh, float a = 1.0);
     void            blurFB(const CFramebuffer& outfb, SBlurParams params);
 
+    // clip drawing on the lock surface to box, never reaching outside the area repainted this frame
+    void            scissor(const CBox& box);
+    void            unscissor();
+
     // Layered rendering methods
     void            renderBackground(const CSessionLockSurface& surf, float opacity);
     void            renderShapes(const CSessionLockSurface& surf, float opacity);
     void            renderInputFields(const CSessionLockSurface& surf, float opacity);
 
     UP<CAsyncResourceGatherer>            asyncResourceGatherer;
-    std::chrono::system_clock::time_point firstFullFrameTime;
+    UP<CBlurCache>                        blurCache;
+    UP<CGlyphAtlas>                       glyphAtlas;
+    UP<CFramebufferPool>                  fbPool;
+    std::chrono::steady_clock::time_point firstFullFrameTime;
 
     void                                  pushFb(GLint fb);
     void                                  popFb();
@@ -67,6 +83,10 @@ class CRenderer {
     widgetMap_t               widgets;
 
     std::vector<SP<IWidget>>& getOrCreateWidgetsFor(const CSessionLockSurface& surf);
+    CRegion                   collectDamage(CSessionLockSurface& surf, const std::vector<SP<IWidget>>& widgets, bool full);
+
+    // bounding box of the region repainted in the current frame, unset outside of renderLock
+    std::optional<CBox>       m_repaintBox;
 
     CShader                   rectShader;
     CShader                   texShader;
@@ -76,6 +96,7 @@ class CRenderer {
     CShader                   blurPrepareShader;
     CShader                   blurFinishShader;
     CShader                   borderShader;
+    CShader                   glyphShader;
 
     Mat3x3                    projMatrix = Mat3x3::identity();
     Mat3x3                    projection;
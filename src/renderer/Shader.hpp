@@ -19,6 +19,7 @@ class CShader {
     GLint   posAttrib         = -1;
     GLint   texAttrib         = -1;
     GLint   matteTexAttrib    = -1;
+    GLint   colorAttrib       = -1;
     GLint   discardOpaque     = -1;
     GLint   discardAlpha      = -1;
     GLfloat discardAlphaValue = -1;
@@ -172,6 +172,32 @@ void main() {
     gl_FragColor = pixColor * alpha;
 })#";
 
+inline const std::string GLYPHVERTSRC = R"#(
+uniform mat3 proj;
+attribute vec2 pos;
+attribute vec2 texcoord;
+attribute vec4 colorAttrib;
+varying vec2 v_texcoord;
+varying vec4 v_color;
+
+void main() {
+    gl_Position = vec4(proj * vec3(pos, 1.0), 1.0);
+    v_texcoord = texcoord;
+    v_color = colorAttrib;
+})#";
+
+inline const std::string GLYPHFRAGSRC = R"#(
+precision highp float;
+varying vec2 v_texcoord;
+varying vec4 v_color; // premultiplied
+uniform sampler2D tex;
+uniform float alpha;
+
+void main() {
+    // glyphs are stored white, colored ones are never tinted by more than their alpha
+    gl_FragColor = texture2D(tex, v_texcoord) * v_color * alpha;
+})#";
+
 inline const std::string FRAGBLUR1 = R"#(
 #version 100
 precision            highp float;
@@ -283,7 +309,7 @@ vec3 hsl2rgb(vec3 col) {
 }
 
 void main() {
-    vec2 uv = v_texcoord * 2.0;
+    vec2 uv = v_texcoord;
 
     vec4 sum = texture2D(tex, uv) * 4.0;
     sum += texture2D(tex, uv - halfpixel.xy * radius);
@@ -326,7 +352,7 @@ uniform float radius;
 uniform vec2 halfpixel;
 
 void main() {
-    vec2 uv = v_texcoord / 2.0;
+    vec2 uv = v_texcoord;
 
     vec4 sum = texture2D(tex, uv + vec2(-halfpixel.x * 2.0, 0.0) * radius);
 
@@ -1,8 +1,26 @@
 #pragma once
 #include "Texture.hpp"
 #include "../defines.hpp"
+#include <cstdint>
 
 struct SPreloadedAsset {
     CTexture texture;
     bool     ready = false;
+    // requests sharing this asset, see CAsyncResourceGatherer::unloadAsset
+    size_t   refs = 0;
+};
+
+// Refers to an asset of the CAsyncResourceGatherer. Resolves to nullptr once that asset is unloaded,
+// also when its slot got reused for another asset since.
+struct SAssetHandle {
+    uint32_t         index      = UINT32_MAX;
+    uint32_t         generation = 0;
+
+    SPreloadedAsset* get() const;
+    SPreloadedAsset* operator->() const {
+        return get();
+    }
+    explicit operator bool() const {
+        return get() != nullptr;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "TextureCompressor.hpp"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+
+// the ETC1 intensity modifier tables, each pixel picks +a, +b, -a or -b of its half's table
+constexpr int ETC_MODIFIERS[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+// pixels of a block are indexed column-major, like the pixel index bits of the format
+using SBlock = std::array<std::array<int, 3>, 16>;
+
+struct SHalfFit {
+    int      table   = 0;
+    int      error   = INT_MAX;
+    // 2 bit pixel indices, at the pixel's position in the block
+    uint32_t indices = 0;
+};
+
+static int expand4(int v) {
+    return (v << 4) | v;
+}
+
+static int expand5(int v) {
+    return (v << 3) | (v >> 2);
+}
+
+static bool inHalf(int pixel, bool flip, int half) {
+    // unflipped halves are the left and right 2x4 columns, flipped ones the top and bottom 4x2 rows
+    const int COORD = flip ? pixel % 4 : pixel / 4;
+    return (COORD < 2) == (half == 0);
+}
+
+static SHalfFit fitHalf(const SBlock& block, bool flip, int half, const std::array<int, 3>& base) {
+    SHalfFit best;
+
+    for (int t = 0; t < 8; ++t) {
+        const int MODS[4] = {ETC_MODIFIERS[t][0], ETC_MODIFIERS[t][1], -ETC_MODIFIERS[t][0], -ETC_MODIFIERS[t][1]};
+
+        SHalfFit  fit{t, 0, 0};
+        for (int p = 0; p < 16 && fit.error < best.error; ++p) {
+            if (!inHalf(p, flip, half))
+                continue;
+
+            int bestErr = INT_MAX, bestIdx = 0;
+            for (int m = 0; m < 4; ++m) {
+                int err = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const int D = std::clamp(base[c] + MODS[m], 0, 255) - block[p][c];
+                    err += D * D;
+                }
+
+                if (err < bestErr) {
+                    bestErr = err;
+                    bestIdx = m;
+                }
+            }
+
+            fit.error += bestErr;
+            fit.indices |= (uint32_t)bestIdx << (p * 2);
+        }
+
+        if (fit.error < best.error)
+            best = fit;
+    }
+
+    return best;
+}
+
+static uint64_t encodeBlock(const SBlock& block) {
+    uint64_t bestBits  = 0;
+    int      bestError = INT_MAX;
+
+    for (const bool FLIP : {false, true}) {
+        std::array<std::array<int, 3>, 2> avg{};
+        for (int p = 0; p < 16; ++p) {
+            for (int c = 0; c < 3; ++c) {
+                avg[inHalf(p, FLIP, 0) ? 0 : 1][c] += block[p][c];
+            }
+        }
+
+        // 5 bit base plus a 3 bit delta if the halves are close enough, 4 bits each otherwise
+        std::array<std::array<int, 3>, 2> q5, q4, base;
+        bool                              differential = true;
+        for (int h = 0; h < 2; ++h) {
+            for (int c = 0; c < 3; ++c) {
+                q5[h][c] = std::lround(avg[h][c] / 8.0 * 31.0 / 255.0);
+                q4[h][c] = std::lround(avg[h][c] / 8.0 * 15.0 / 255.0);
+            }
+        }
+
+        for (int c = 0; c < 3; ++c) {
+            const int D = q5[1][c] - q5[0][c];
+            differential = differential && D >= -4 && D <= 3;
+        }
+
+        for (int h = 0; h < 2; ++h) {
+            for (int c = 0; c < 3; ++c) {
+                base[h][c] = differential ? expand5(q5[h][c]) : expand4(q4[h][c]);
+            }
+        }
+
+        const auto FIRST  = fitHalf(block, FLIP, 0, base[0]);
+        const auto SECOND = fitHalf(block, FLIP, 1, base[1]);
+        if (FIRST.error + SECOND.error >= bestError)
+            continue;
+
+        bestError = FIRST.error + SECOND.error;
+
+        uint64_t bits = 0;
+        if (differential) {
+            for (int c = 0; c < 3; ++c) {
+                bits |= (uint64_t)q5[0][c] << (59 - c * 8);
+                bits |= (uint64_t)((q5[1][c] - q5[0][c]) & 7) << (56 - c * 8);
+            }
+        } else {
+            for (int c = 0; c < 3; ++c) {
+                bits |= (uint64_t)q4[0][c] << (60 - c * 8);
+                bits |= (uint64_t)q4[1][c] << (56 - c * 8);
+            }
+        }
+
+        bits |= (uint64_t)FIRST.table << 37;
+        bits |= (uint64_t)SECOND.table << 34;
+        bits |= (uint64_t)differential << 33;
+        bits |= (uint64_t)FLIP << 32;
+
+        // +a, +b, -a, -b are stored as 0, 1, 2, 3 with the msb in the upper 16 bits
+        const uint32_t INDICES = FIRST.indices | SECOND.indices;
+        for (int p = 0; p < 16; ++p) {
+            const uint32_t IDX = (INDICES >> (p * 2)) & 3;
+            bits |= (uint64_t)(IDX >> 1) << (16 + p);
+            bits |= (uint64_t)(IDX & 1) << p;
+        }
+
+        bestBits = bits;
+    }
+
+    return bestBits;
+}
+
+size_t CTextureCompressor::etc2Size(int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+std::vector<uint8_t> CTextureCompressor::encodeETC2(const uint8_t* bgra, int width, int height, size_t stride, uint32_t& levels) {
+    // tightly packed rgb of the current level
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* PX  = bgra + y * stride + x * 4;
+            uint8_t*       OUT = rgb.data() + ((size_t)y * width + x) * 3;
+            OUT[0]             = PX[2];
+            OUT[1]             = PX[1];
+            OUT[2]             = PX[0];
+        }
+    }
+
+    std::vector<uint8_t> out;
+    levels = 0;
+
+    int w = width, h = height;
+    while (true) {
+        const size_t OFFSET = out.size();
+        out.resize(OFFSET + etc2Size(w, h));
+        uint8_t* dst = out.data() + OFFSET;
+
+        for (int by = 0; by < h; by += 4) {
+            for (int bx = 0; bx < w; bx += 4) {
+                // edge blocks repeat the last row and column
+                SBlock block;
+                for (int p = 0; p < 16; ++p) {
+                    const int      X  = std::min(bx + p / 4, w - 1);
+                    const int      Y  = std::min(by + p % 4, h - 1);
+                    const uint8_t* PX = rgb.data() + ((size_t)Y * w + X) * 3;
+                    block[p]          = {PX[0], PX[1], PX[2]};
+                }
+
+                const uint64_t BITS = encodeBlock(block);
+                for (int i = 0; i < 8; ++i) {
+                    *dst++ = (BITS >> (56 - i * 8)) & 0xFF;
+                }
+            }
+        }
+
+        levels++;
+        if (w == 1 && h == 1)
+            break;
+
+        // box filter down to the next level
+        const int            NW = std::max(1, w / 2), NH = std::max(1, h / 2);
+        std::vector<uint8_t> next((size_t)NW * NH * 3);
+        for (int y = 0; y < NH; ++y) {
+            for (int x = 0; x < NW; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    const int X0 = std::min(x * 2, w - 1), X1 = std::min(x * 2 + 1, w - 1);
+                    const int Y0 = std::min(y * 2, h - 1), Y1 = std::min(y * 2 + 1, h - 1);
+                    const int SUM = rgb[((size_t)Y0 * w + X0) * 3 + c] + rgb[((size_t)Y0 * w + X1) * 3 + c] + rgb[((size_t)Y1 * w + X0) * 3 + c] +
+                        rgb[((size_t)Y1 * w + X1) * 3 + c];
+                    next[((size_t)y * NW + x) * 3 + c] = (SUM + 2) / 4;
+                }
+            }
+        }
+
+        rgb = std::move(next);
+        w   = NW;
+        h   = NH;
+    }
+
+    return out;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU encoder for GL_COMPRESSED_RGB8_ETC2, the compressed format every GLES 3 driver has to accept.
+// It only emits ETC1 style blocks (ETC2 decodes those unchanged) and searches them exhaustively per block,
+// which is plenty for wallpapers and fast enough for --precompile-assets. There is no alpha, so only opaque images qualify.
+class CTextureCompressor {
+  public:
+    // bytes of one level
+    static size_t               etc2Size(int width, int height);
+
+    // bgra as cairo's ARGB32 stores it. Encodes the full mip chain down to 1x1, levels one after another.
+    static std::vector<uint8_t> encodeETC2(const uint8_t* bgra, int width, int height, size_t stride, uint32_t& levels);
+};
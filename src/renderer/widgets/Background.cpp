@@ -1,6 +1,7 @@
 #include "Background.hpp"
 #include "../Renderer.hpp"
 #include "../AsyncResourceGatherer.hpp"
+#include "../ImageCache.hpp"
 #include "../../core/mpvlock.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../helpers/MiscFunctions.hpp"
@@ -8,10 +9,14 @@
 #include <hyprlang.hpp>
 #include <filesystem>
 #include <memory>
+#include <algorithm>
 #include <cstring>
 #include <GLES3/gl32.h>
 #include <magic.h>
 
+// how long a late image takes to replace the placeholder, unless crossfade_time says otherwise
+constexpr uint64_t PLACEHOLDER_FADE_MS = 300;
+
 extern UP<CRenderer> g_pRenderer;
 
 CBackground::~CBackground() {
@@ -43,32 +48,19 @@ bool CBackground::isVideoBackground() const {
     return m_bIsVideoBackground;
 }
 
+CBox CBackground::getDamageBox() const {
+    if (m_bIsVideoBackground)
+        return {};
+
+    return {0, 0, viewport.x, viewport.y};
+}
+
 void CBackground::onTimer(std::shared_ptr<CTimer> timer, void* data) {
     WP<CBackground> ref = *static_cast<WP<CBackground>*>(data);
     if (auto PBACKGROUND = ref.lock(); PBACKGROUND) {
         if (timer == PBACKGROUND->reloadTimer) {
             PBACKGROUND->onReloadTimerUpdate();
             PBACKGROUND->plantReloadTimer();
-        } else if (timer == PBACKGROUND->fadeAnimation.fadeTimer) {
-            auto now = std::chrono::system_clock::now();
-            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - PBACKGROUND->fadeAnimation.startTime).count();
-            float progress = static_cast<float>(elapsedMs) / PBACKGROUND->fadeAnimation.durationMs;
-
-            if (progress >= 1.0f) {
-                // Fading complete
-                PBACKGROUND->fadeAnimation.opacity = PBACKGROUND->fadeAnimation.fadingIn ? 1.0f : 0.0f;
-                PBACKGROUND->fadeAnimation.fadeTimer->cancel();
-                PBACKGROUND->fadeAnimation.fadeTimer.reset();
-                PBACKGROUND->fadeAnimation.fadingIn = !PBACKGROUND->fadeAnimation.fadingIn;
-                Debug::log(TRACE, "CBackground fading complete: opacity={}", PBACKGROUND->fadeAnimation.opacity);
-            } else {
-                // Update opacity
-                PBACKGROUND->fadeAnimation.opacity = PBACKGROUND->fadeAnimation.fadingIn ? progress : 1.0f - progress;
-                Debug::log(TRACE, "CBackground fading: progress={}, opacity={}", progress, PBACKGROUND->fadeAnimation.opacity);
-            }
-
-            // Trigger a render
-            g_pMpvlock->renderOutput(PBACKGROUND->outputPort);
         } else if (timer == PBACKGROUND->fade->crossFadeTimer) {
             PBACKGROUND->onCrossFadeTimerUpdate();
         }
@@ -144,6 +136,20 @@ void CBackground::configure(const std::unordered_map<std::string, std::any>& pro
             }
         }
 
+        blurScale = 1.f;
+        if (props.contains("blur_scale")) {
+            try {
+                const auto& val = props.at("blur_scale");
+                if (val.type() == typeid(Hyprlang::FLOAT)) {
+                    blurScale = std::clamp(std::any_cast<Hyprlang::FLOAT>(val), 0.05f, 1.f);
+                } else {
+                    Debug::log(WARN, "blur_scale has unexpected type, using default: 1.0");
+                }
+            } catch (const std::exception& e) {
+                Debug::log(ERR, "Failed to parse blur_scale: {}", e.what());
+            }
+        }
+
         vibrancy = 0.1696f;
         if (props.contains("vibrancy")) {
             try {
@@ -336,6 +342,8 @@ void CBackground::configure(const std::unordered_map<std::string, std::any>& pro
         m_bIsVideoBackground = false;
         videoPath = "";
         resourceID = "";
+        blurSource = "";
+        blurredTex.reset();
 
         // Check if path is a video using libmagic
         if (!path.empty()) {
@@ -423,12 +431,21 @@ void CBackground::configure(const std::unordered_map<std::string, std::any>& pro
 
             if (!targetPath.empty() && !targetPath.ends_with(".mp4") && !targetPath.ends_with(".mkv")) {
                 resourceID = isScreenshot ? CScreencopyFrame::getResourceId(pOutput) : "background:" + targetPath;
-                if (!isScreenshot) {
+                if (!isScreenshot)
+                    loadCachedBlur(targetPath);
+                if (!isScreenshot && !blurredTex && g_pMpvlock->m_bImmediateRender)
+                    loadPlaceholder(targetPath);
+
+                if (blurredTex)
+                    Debug::log(LOG, "Using cached blur for resource: {}", resourceID);
+                else if (!isScreenshot) {
                     CAsyncResourceGatherer::SPreloadRequest request;
                     request.id = resourceID;
                     request.asset = targetPath;
                     request.type = CAsyncResourceGatherer::eTargetType::TARGET_IMAGE;
-                    request.callback = [REF = m_self]() { REF.lock()->startCrossFadeOrUpdateRender(); };
+                    request.sizeHint = viewport;
+                    request.thumbnail = true;
+                    request.callback = [REF = m_self]() { if (auto PBACKGROUND = REF.lock()) PBACKGROUND->startCrossFadeOrUpdateRender(); };
                     g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
                     Debug::log(LOG, "Requested async preload for resource: {}", resourceID);
                 }
@@ -459,10 +476,7 @@ void CBackground::configure(const std::unordered_map<std::string, std::any>& pro
             plantReloadTimer();
         }
 
-        // Start fading if enabled
-        if (fadeAnimation.enabled) {
-            startFade();
-        }
+        startFadeIn(fadeAnimation);
     } catch (const std::exception& e) {
         Debug::log(ERR, "Exception in CBackground::configure: {}", e.what());
         m_bIsVideoBackground = false;
@@ -482,10 +496,6 @@ void CBackground::reset() {
         }
         fade.reset();
     }
-    if (fadeAnimation.fadeTimer) {
-        fadeAnimation.fadeTimer->cancel();
-        fadeAnimation.fadeTimer.reset();
-    }
 }
 
 void CBackground::renderRect(CHyprColor color) {
@@ -501,7 +511,7 @@ bool CBackground::draw(const SRenderData& data) {
         return false;
     }
 
-    float adjustedOpacity = data.opacity * fadeAnimation.opacity;
+    float adjustedOpacity = data.opacity * fadeAnimation.value();
 
     if (resourceID.empty()) {
         CHyprColor col = color;
@@ -510,14 +520,31 @@ bool CBackground::draw(const SRenderData& data) {
         return adjustedOpacity < 1.0;
     }
 
-    if (!asset)
+    // another output may have stored this blur since we were configured
+    if (!blurredTex && !fade && !blurSource.empty())
+        blurredTex = g_pRenderer->blurCache->get(blurSource, blurVariant());
+
+    if (blurredTex && !fade) {
+        renderCover(*blurredTex, adjustedOpacity);
+        return adjustedOpacity < 1.0;
+    }
+
+    if (!asset) {
         asset = g_pRenderer->asyncResourceGatherer->getAssetByID(resourceID);
 
+        if (asset && placeholderDrawn) {
+            assetFadeIn.enabled    = true;
+            assetFadeIn.durationMs = crossFadeTime > 0 ? crossFadeTime * 1000 : PLACEHOLDER_FADE_MS;
+            startFadeIn(assetFadeIn);
+            placeholderDrawn = false;
+        }
+    }
+
+    // the gatherer repaints once the asset is uploaded, no need to poll for it
     if (!asset) {
-        CHyprColor col = color;
-        col.a *= adjustedOpacity;
-        renderRect(col);
-        return true;
+        placeholderDrawn = true;
+        renderPlaceholder(adjustedOpacity);
+        return adjustedOpacity < 1.0;
     }
 
     if (asset->texture.m_iType == TEXTURE_INVALID) {
@@ -552,11 +579,12 @@ bool CBackground::draw(const SRenderData& data) {
         if (!blurredFB.isAllocated())
             blurredFB.alloc((int)viewport.x, (int)viewport.y);
 
+        g_pRenderer->pushFb(blurredFB.m_iFb);
         blurredFB.bind();
 
         if (fade)
             g_pRenderer->renderTextureMix(texbox, asset->texture, pendingAsset->texture, 1.0,
-                                          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - fade->start).count() / (1000 * crossFadeTime), 0,
+                                          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - fade->start).count() / (1000 * crossFadeTime), 0,
                                           transform);
         else
             g_pRenderer->renderTexture(texbox, asset->texture, 1.0, 0, transform);
@@ -569,16 +597,32 @@ bool CBackground::draw(const SRenderData& data) {
                                                        .contrast = contrast,
                                                        .brightness = brightness,
                                                        .vibrancy = vibrancy,
-                                                       .vibrancy_darkness = vibrancy_darkness});
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                                                       .vibrancy_darkness = vibrancy_darkness,
+                                                       .scale = blurScale});
+        g_pRenderer->popFb();
+
+        if (!fade && blurPasses > 0 && !blurSource.empty())
+            blurredTex = g_pRenderer->blurCache->store(blurSource, blurVariant(), blurredFB, true);
     }
 
-    CTexture* tex = blurredFB.isAllocated() ? &blurredFB.m_cTex : &asset->texture;
+    const float ASSETOPACITY = assetFadeIn.value();
+    if (ASSETOPACITY < 1.0)
+        renderPlaceholder(adjustedOpacity);
+    else
+        placeholderTex.reset();
+
+    if (blurredTex && !fade)
+        renderCover(*blurredTex, adjustedOpacity * ASSETOPACITY);
+    else
+        renderCover(blurredFB.isAllocated() ? blurredFB.m_cTex : asset->texture, adjustedOpacity * ASSETOPACITY);
+
+    return fade || adjustedOpacity < 1.0 || ASSETOPACITY < 1.0;
+}
 
-    CBox      texbox = {{}, tex->m_vSize};
-    Vector2D  size   = tex->m_vSize;
-    float     scaleX = viewport.x / tex->m_vSize.x;
-    float     scaleY = viewport.y / tex->m_vSize.y;
+void CBackground::renderCover(const CTexture& tex, float opacity) {
+    CBox  texbox = {{}, tex.m_vSize};
+    float scaleX = viewport.x / tex.m_vSize.x;
+    float scaleY = viewport.y / tex.m_vSize.y;
 
     texbox.w *= std::max(scaleX, scaleY);
     texbox.h *= std::max(scaleX, scaleY);
@@ -588,18 +632,65 @@ bool CBackground::draw(const SRenderData& data) {
     else
         texbox.x = -(texbox.w - viewport.x) / 2.f;
     texbox.round();
-    g_pRenderer->renderTexture(texbox, *tex, adjustedOpacity, 0, HYPRUTILS_TRANSFORM_FLIPPED_180);
+    g_pRenderer->renderTexture(texbox, tex, opacity, 0, HYPRUTILS_TRANSFORM_FLIPPED_180);
+}
+
+void CBackground::renderPlaceholder(float opacity) {
+    if (placeholderTex) {
+        renderCover(*placeholderTex, opacity);
+        return;
+    }
+
+    CHyprColor col = color;
+    col.a *= opacity;
+    renderRect(col);
+}
+
+void CBackground::loadPlaceholder(const std::string& assetPath) {
+    placeholderTex.reset();
+
+    const auto THUMB = CImageCache::loadThumbnail(CBlurCache::sourceID(assetPath));
+    if (!THUMB)
+        return;
+
+    placeholderTex = makeShared<CTexture>();
+    placeholderTex->allocate();
+    placeholderTex->m_vSize = THUMB->size;
+
+    glBindTexture(GL_TEXTURE_2D, placeholderTex->m_iTexID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, THUMB->size.x, THUMB->size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, THUMB->pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    Debug::log(LOG, "Using a {}x{} thumbnail of {} until it is loaded", THUMB->size.x, THUMB->size.y, assetPath);
+}
+
+std::string CBackground::blurVariant() const {
+    return std::format("{}x{},size:{},passes:{},scale:{},noise:{},contrast:{},brightness:{},vibrancy:{},vibrancy_darkness:{}", viewport.x, viewport.y, blurSize, blurPasses,
+                       blurScale, noise, contrast, brightness, vibrancy, vibrancy_darkness);
+}
+
+void CBackground::loadCachedBlur(const std::string& assetPath) {
+    blurredTex.reset();
+    blurSource = blurPasses > 0 ? CBlurCache::sourceID(assetPath) : "";
 
-    return fade || adjustedOpacity < 1.0;
+    if (!blurSource.empty())
+        blurredTex = g_pRenderer->blurCache->get(blurSource, blurVariant());
 }
 
 void CBackground::plantReloadTimer() {
     if (reloadTime == 0)
         reloadTimer = g_pMpvlock->addTimer(std::chrono::hours(1),
-            [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr, true);
+            [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PBACKGROUND = REF.lock()) PBACKGROUND->onTimer(timer, (void*)&REF); }, nullptr, true);
     else if (reloadTime > -1)
         reloadTimer = g_pMpvlock->addTimer(std::chrono::seconds(reloadTime),
-            [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr, true);
+            [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PBACKGROUND = REF.lock()) PBACKGROUND->onTimer(timer, (void*)&REF); }, nullptr, true);
 }
 
 void CBackground::onReloadTimerUpdate() {
@@ -636,8 +727,10 @@ void CBackground::onReloadTimerUpdate() {
     pendingResourceID = request.id;
     request.asset = path;
     request.type = CAsyncResourceGatherer::eTargetType::TARGET_IMAGE;
+    request.sizeHint = viewport;
+    request.thumbnail = true;
 
-    request.callback = [REF = m_self]() { REF.lock()->startCrossFadeOrUpdateRender(); };
+    request.callback = [REF = m_self]() { if (auto PBACKGROUND = REF.lock()) PBACKGROUND->startCrossFadeOrUpdateRender(); };
     g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
 }
 
@@ -653,9 +746,13 @@ void CBackground::onCrossFadeTimerUpdate() {
     asset = pendingAsset;
     resourceID = pendingResourceID;
     pendingResourceID = "";
-    pendingAsset = nullptr;
+    pendingAsset = {};
     firstRender = true;
 
+    if (!isScreenshot)
+        loadCachedBlur(path.empty() ? fallbackPath : path);
+
+    damage();
     g_pMpvlock->renderOutput(outputPort);
 }
 
@@ -667,7 +764,8 @@ void CBackground::startCrossFadeOrUpdateRender() {
             Debug::log(ERR, "New asset had an invalid texture!");
         } else if (resourceID != pendingResourceID) {
             pendingAsset = newAsset;
-            if (crossFadeTime > 0) {
+            // nothing to fade from when the old image came straight from the blur cache
+            if (crossFadeTime > 0 && asset) {
                 if (!fade)
                     fade = makeUnique<SFade>();
                 else {
@@ -676,11 +774,11 @@ void CBackground::startCrossFadeOrUpdateRender() {
                         fade->crossFadeTimer.reset();
                     }
                 }
-                fade->start = std::chrono::system_clock::now();
+                fade->start = std::chrono::steady_clock::now();
                 fade->a = 0;
                 fade->crossFadeTimer =
                     g_pMpvlock->addTimer(std::chrono::milliseconds((int)(1000.0 * crossFadeTime)),
-                        [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr, true);
+                        [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PBACKGROUND = REF.lock()) PBACKGROUND->onTimer(timer, (void*)&REF); }, nullptr, true);
             } else {
                 onCrossFadeTimerUpdate();
             }
@@ -688,20 +786,9 @@ void CBackground::startCrossFadeOrUpdateRender() {
     } else if (!pendingResourceID.empty()) {
         Debug::log(WARN, "Asset {} not available after the asyncResourceGatherer's callback!", pendingResourceID);
         g_pMpvlock->addTimer(std::chrono::milliseconds(100),
-            [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->startCrossFadeOrUpdateRender(); }, nullptr, true);
+            [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PBACKGROUND = REF.lock()) PBACKGROUND->startCrossFadeOrUpdateRender(); }, nullptr, true);
     }
 
+    damage();
     g_pMpvlock->renderOutput(outputPort);
 }
-
-void CBackground::startFade() {
-    if (!fadeAnimation.enabled || fadeAnimation.fadeTimer) {
-        return;
-    }
-
-    fadeAnimation.startTime = std::chrono::system_clock::now();
-    fadeAnimation.fadeTimer = g_pMpvlock->addTimer(std::chrono::milliseconds(16),
-                                                   [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); },
-                                                   nullptr, false);
-    Debug::log(LOG, "CBackground starting fade: fadingIn={}, duration={}ms", fadeAnimation.fadingIn, fadeAnimation.durationMs);
-}
\ No newline at end of file
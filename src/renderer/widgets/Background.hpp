@@ -13,11 +13,10 @@
 #include <chrono>
 #include <filesystem>
 
-struct SPreloadedAsset;
 class COutput;
 
 struct SFade {
-    std::chrono::system_clock::time_point start;
+    std::chrono::steady_clock::time_point start;
     float                                 a              = 0;
     std::shared_ptr<CTimer>               crossFadeTimer = nullptr;
 };
@@ -36,6 +35,7 @@ class CBackground : public IWidget {
     virtual int getZindex() const override;
     virtual void onTimer(std::shared_ptr<CTimer> timer, void* data) override;
     virtual bool isVideoBackground() const;
+    virtual CBox getDamageBox() const override;
 
     void         reset();
 
@@ -45,7 +45,8 @@ class CBackground : public IWidget {
     void         onCrossFadeTimerUpdate();
     void         plantReloadTimer();
     void         startCrossFadeOrUpdateRender();
-    void         startFade(); // Add method to start the new fading animation
+    void         loadCachedBlur(const std::string& assetPath);
+    void         loadPlaceholder(const std::string& assetPath);
 
     bool         m_bIsVideoBackground = false;
     std::string  videoPath;
@@ -53,13 +54,22 @@ class CBackground : public IWidget {
     std::string  fallbackPath;
 
   private:
+    std::string                             blurVariant() const;
+    void                                    renderCover(const CTexture& tex, float opacity);
+    // the thumbnail if there is one, the color otherwise
+    void                                    renderPlaceholder(float opacity);
+
     int                                     m_iZindex = -1;
     WP<CBackground>                         m_self;
 
     CFramebuffer                            blurredFB;
+    // finished blur shared with other outputs through the renderer's blur cache, replaces blurredFB outside of crossfades
+    SP<CTexture>                            blurredTex;
+    std::string                             blurSource;
 
     int                                     blurSize          = 10;
     int                                     blurPasses        = 3;
+    float                                   blurScale         = 1.0;
     float                                   noise             = 0.0117;
     float                                   contrast          = 0.8916;
     float                                   brightness        = 0.8172;
@@ -77,9 +87,9 @@ class CBackground : public IWidget {
     float                                   crossFadeTime = -1.0;
 
     CHyprColor                              color;
-    SPreloadedAsset*                        asset        = nullptr;
+    SAssetHandle                            asset;
     bool                                    isScreenshot = false;
-    SPreloadedAsset*                        pendingAsset = nullptr;
+    SAssetHandle                            pendingAsset;
     bool                                    firstRender  = true;
 
     UP<SFade>                               fade; // Existing crossfade structure
@@ -91,12 +101,11 @@ class CBackground : public IWidget {
     std::filesystem::file_time_type         modificationTime;
 
     // New fading functionality (distinct from crossfade)
-    struct {
-        float opacity = 1.0f;
-        bool enabled = false;
-        bool fadingIn = true;
-        uint64_t durationMs = 1000;
-        std::shared_ptr<CTimer> fadeTimer = nullptr;
-        std::chrono::system_clock::time_point startTime;
-    } fadeAnimation;
+    SFadeIn                                 fadeAnimation;
+
+    // with immediate_render the lock shows before the image is loaded. It then blends in over the color it was drawn with until then.
+    bool                                    placeholderDrawn = false;
+    SFadeIn                                 assetFadeIn;
+    // a blurred thumbnail from the image cache, upscaled by GL
+    SP<CTexture>                            placeholderTex;
 };
@@ -1,8 +1,13 @@
 #include "IWidget.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../core/mpvlock.hpp"
+#include "../../core/AnimationManager.hpp"
 #include "../../auth/Auth.hpp"
+#include "../../core/Clock.hpp"
+#include <algorithm>
 #include <chrono>
+#include <optional>
+#include <string_view>
 #include <unistd.h>
 #include <pwd.h>
 #include <hyprutils/string/String.hpp>
@@ -10,18 +15,6 @@
 
 using namespace Hyprutils::String;
 
-#if defined(_LIBCPP_VERSION) && _LIBCPP_VERSION < 190100
-#pragma comment(lib, "date-tz")
-#include <date/tz.h>
-namespace std {
-    namespace chrono {
-        using date::current_zone;
-        using date::locate_zone;
-        using date::time_zone;
-    }
-}
-#endif
-
 static Vector2D rotateVector(const Vector2D& vec, const double& ang) {
     const double COS = std::abs(std::cos(ang));
     const double SIN = std::abs(std::sin(ang));
@@ -76,167 +69,211 @@ int IWidget::roundingForBorderBox(const CBox& borderBox, int roundingConfig, int
     return std::clamp(roundingConfig + thickness, 0, MINHALFBORDER);
 }
 
-static void replaceAllAttempts(std::string& str) {
+CBox IWidget::boundingBoxForRotation(const CBox& box) {
+    if (box.rot == 0)
+        return box;
 
-    const size_t      ATTEMPTS = g_pAuth->getFailedAttempts();
-    const std::string STR      = std::to_string(ATTEMPTS);
-    size_t            pos      = 0;
+    const auto SIZE   = rotateVector(box.size(), box.rot);
+    const auto CENTER = box.middle();
+    return CBox{CENTER - SIZE / 2.0, SIZE}.round();
+}
 
-    while ((pos = str.find("$ATTEMPTS", pos)) != std::string::npos) {
-        if (str.substr(pos, 10).ends_with('[') && str.substr(pos).contains(']')) {
-            const std::string REPL = str.substr(pos + 10, str.find_first_of(']', pos) - 10 - pos);
-            if (ATTEMPTS == 0) {
-                str.replace(pos, 11 + REPL.length(), REPL);
-                pos += REPL.length();
-            } else {
-                str.replace(pos, 11 + REPL.length(), STR);
-                pos += STR.length();
-            }
-        } else {
-            str.replace(pos, 9, STR);
-            pos += STR.length();
-        }
-    }
+bool IWidget::isDamaged() const {
+    return m_bDamaged;
 }
 
-static void replaceAllLayout(std::string& str) {
+void IWidget::damage() {
+    m_bDamaged = true;
+}
+
+void IWidget::onDrawn(bool needsFrame) {
+    // widgets that asked for another frame are still changing
+    m_bDamaged      = needsFrame;
+    m_lastDamageBox = getDamageBox();
+}
+
+const CBox& IWidget::getLastDamageBox() const {
+    return m_lastDamageBox;
+}
+
+float IWidget::SFadeIn::value() const {
+    return opacity ? opacity->value() : 1.f;
+}
 
+void IWidget::startFadeIn(SFadeIn& fade) {
+    if (!fade.enabled)
+        return;
+
+    fade.config = g_pAnimationManager->makeTimedConfig("widgetFade", fade.durationMs);
+    g_pAnimationManager->createAnimation(0.f, fade.opacity, fade.config);
+    // the variable is owned by the widget, so this can't outlive it
+    fade.opacity->setUpdateCallback([this](auto) { damage(); });
+    *fade.opacity = 1.f;
+
+    Debug::log(LOG, "{} starting fade: duration={}ms", type(), fade.durationMs);
+}
+
+static std::string formatAttempts(const IWidget::SFormatToken& token) {
+    const size_t ATTEMPTS = g_pAuth->getFailedAttempts();
+
+    // $ATTEMPTS[text] shows text until the first failure
+    if (token.hasArg && ATTEMPTS == 0)
+        return token.text;
+
+    return std::to_string(ATTEMPTS);
+}
+
+static std::string formatLayout(const IWidget::SFormatToken& token) {
     const auto LAYOUTIDX  = g_pMpvlock->m_uiActiveLayout;
     const auto LAYOUTNAME = g_pSeatManager->getActiveKbLayoutName();
-    size_t     pos        = 0;
-
-    while ((pos = str.find("$LAYOUT", pos)) != std::string::npos) {
-        if (str.substr(pos, 8).ends_with('[') && str.substr(pos).contains(']')) {
-            const std::string REPL = str.substr(pos + 8, str.find_first_of(']', pos) - 8 - pos);
-            const CVarList    LANGS(REPL);
-            if (LAYOUTIDX >= LANGS.size()) {
-                Debug::log(ERR, "Layout index {} out of bounds. Max is {}.", LAYOUTIDX, LANGS.size() - 1);
-                continue;
-            }
 
-            const std::string LANG = LANGS[LAYOUTIDX].empty() ? LAYOUTNAME : LANGS[LAYOUTIDX] == "!" ? "" : LANGS[LAYOUTIDX];
-            str.replace(pos, 9 + REPL.length(), LANG);
-            pos += LANG.length();
-        } else {
-            str.replace(pos, 7, LAYOUTNAME);
-            pos += LAYOUTNAME.length();
-        }
-    }
-}
+    if (!token.hasArg)
+        return LAYOUTNAME;
 
-static bool                                                       logMissingTzOnce = true;
-static std::chrono::hh_mm_ss<std::chrono::system_clock::duration> getTime() {
-    const std::chrono::time_zone* pCurrentTz = nullptr;
-    try {
-        auto name = std::getenv("TZ");
-        if (name)
-            pCurrentTz = std::chrono::locate_zone(name);
-    } catch (std::runtime_error&) { Debug::log(WARN, "Invalid TZ value. Falling back to current timezone!"); }
-
-    if (!pCurrentTz)
-        pCurrentTz = std::chrono::current_zone();
-
-    const auto TPNOW = std::chrono::system_clock::now();
-
-    //
-    std::chrono::hh_mm_ss<std::chrono::system_clock::duration> hhmmss;
-    if (!pCurrentTz) {
-        if (logMissingTzOnce) {
-            Debug::log(WARN, "Current timezone unknown. Falling back to UTC!");
-            logMissingTzOnce = false;
-        }
-        hhmmss = std::chrono::hh_mm_ss{TPNOW - std::chrono::floor<std::chrono::days>(TPNOW)};
-    } else
-        hhmmss = std::chrono::hh_mm_ss{pCurrentTz->to_local(TPNOW) - std::chrono::floor<std::chrono::days>(pCurrentTz->to_local(TPNOW))};
+    const CVarList LANGS(token.text);
+    if (LAYOUTIDX >= LANGS.size()) {
+        Debug::log(ERR, "Layout index {} out of bounds. Max is {}.", LAYOUTIDX, LANGS.size() - 1);
+        return LAYOUTNAME;
+    }
 
-    return hhmmss;
+    return LANGS[LAYOUTIDX].empty() ? LAYOUTNAME : LANGS[LAYOUTIDX] == "!" ? "" : LANGS[LAYOUTIDX];
 }
 
-static std::string getTime24h() {
-    const auto HHMMSS = getTime();
+static std::string getTime24h(const std::chrono::hh_mm_ss<std::chrono::system_clock::duration>& HHMMSS) {
     const auto HRS    = HHMMSS.hours().count();
     const auto MINS   = HHMMSS.minutes().count();
     return (HRS < 10 ? "0" : "") + std::to_string(HRS) + ":" + (MINS < 10 ? "0" : "") + std::to_string(MINS);
 }
 
-static std::string getTime12h() {
-    const auto HHMMSS = getTime();
+static std::string getTime12h(const std::chrono::hh_mm_ss<std::chrono::system_clock::duration>& HHMMSS) {
     const auto HRS    = HHMMSS.hours().count();
     const auto MINS   = HHMMSS.minutes().count();
     return (HRS == 12 || HRS == 0 ? "12" : (HRS % 12 < 10 ? "0" : "") + std::to_string(HRS % 12)) + ":" + (MINS < 10 ? "0" : "") + std::to_string(MINS) +
         (HRS < 12 ? " AM" : " PM");
 }
 
-IWidget::SFormatResult IWidget::formatString(std::string in) {
+struct SUserInfo {
+    std::string name;
+    std::string gecos;
+};
+
+// doesn't change while we're running, so it is looked up once
+static const SUserInfo& userInfo() {
+    static const SUserInfo INFO = []() {
+        SUserInfo info;
+        const auto* uidPassword = getpwuid(getuid());
+        if (!uidPassword || !uidPassword->pw_name)
+            Debug::log(ERR, "Error in formatString, username null. Errno: ", errno);
+        else
+            info.name = uidPassword->pw_name;
+
+        if (!uidPassword || !uidPassword->pw_gecos)
+            Debug::log(WARN, "Error in formatString, user_gecos null. Errno: ", errno);
+        else
+            info.gecos = uidPassword->pw_gecos;
+
+        return info;
+    }();
+
+    return INFO;
+}
 
-    auto  uidPassword = getpwuid(getuid());
-    char* username    = uidPassword->pw_name;
-    char* user_gecos  = uidPassword->pw_gecos;
+// longer names first where one is a prefix of another
+static const std::pair<std::string_view, IWidget::eFormatVariable> FORMAT_VARIABLES[] = {
+    {"$DESC", IWidget::FORMAT_DESC},
+    {"$USER", IWidget::FORMAT_USER},
+    {"$TIME12", IWidget::FORMAT_TIME12},
+    {"$TIME", IWidget::FORMAT_TIME},
+    {"$ATTEMPTS", IWidget::FORMAT_ATTEMPTS},
+    {"$LAYOUT", IWidget::FORMAT_LAYOUT},
+    {"$FAIL", IWidget::FORMAT_FAIL},
+    {"$PAMFAIL", IWidget::FORMAT_PAMFAIL},
+    {"$PAMPROMPT", IWidget::FORMAT_PAMPROMPT},
+    {"$FPRINTFAIL", IWidget::FORMAT_FPRINTFAIL},
+    {"$FPRINTPROMPT", IWidget::FORMAT_FPRINTPROMPT},
+};
+
+static uint32_t dependencyOf(IWidget::eFormatVariable variable) {
+    switch (variable) {
+        case IWidget::FORMAT_TIME:
+        case IWidget::FORMAT_TIME12: return IWidget::FORMAT_DEP_TIME;
+        case IWidget::FORMAT_LAYOUT: return IWidget::FORMAT_DEP_LAYOUT;
+        case IWidget::FORMAT_ATTEMPTS:
+        case IWidget::FORMAT_FAIL:
+        case IWidget::FORMAT_PAMFAIL:
+        case IWidget::FORMAT_PAMPROMPT:
+        case IWidget::FORMAT_FPRINTFAIL:
+        case IWidget::FORMAT_FPRINTPROMPT: return IWidget::FORMAT_DEP_AUTH;
+        default: return IWidget::FORMAT_DEP_NONE;
+    }
+}
 
-    if (!username)
-        Debug::log(ERR, "Error in formatString, username null. Errno: ", errno);
+IWidget::SFormatTemplate IWidget::compileFormat(std::string in) {
+    SFormatTemplate format;
 
-    if (!user_gecos)
-        Debug::log(WARN, "Error in formatString, user_gecos null. Errno: ", errno);
+    const bool      ISCMD = in.starts_with("cmd[") && in.contains("]");
+    std::string     cmdOptions;
+    if (ISCMD) {
+        // this is a command
+        cmdOptions = in.substr(4, in.find_first_of(']') - 4);
+        in         = in.substr(in.find_first_of(']') + 1);
+    }
 
-    IWidget::SFormatResult result;
-    replaceInString(in, "$DESC", std::string{user_gecos ? user_gecos : ""});
-    replaceInString(in, "$USER", std::string{username ? username : ""});
-    replaceInString(in, "<br/>", std::string{"\n"});
+    std::string literal;
+    const auto  FLUSHLITERAL = [&]() {
+        if (!literal.empty())
+            format.tokens.push_back({.text = std::move(literal)});
+        literal.clear();
+    };
+
+    for (size_t pos = 0; pos < in.size();) {
+        if (in.compare(pos, 5, "<br/>") == 0) {
+            literal += '\n';
+            pos += 5;
+            continue;
+        }
 
-    if (in.contains("$TIME12")) {
-        replaceInString(in, "$TIME12", getTime12h());
-        result.updateEveryMs = result.updateEveryMs != 0 && result.updateEveryMs < 1000 ? result.updateEveryMs : 1000;
-    }
+        const auto VARIABLE =
+            in[pos] != '$' ? std::ranges::end(FORMAT_VARIABLES) : std::ranges::find_if(FORMAT_VARIABLES, [&](const auto& v) { return in.compare(pos, v.first.size(), v.first) == 0; });
 
-    if (in.contains("$TIME")) {
-        replaceInString(in, "$TIME", getTime24h());
-        result.updateEveryMs = result.updateEveryMs != 0 && result.updateEveryMs < 1000 ? result.updateEveryMs : 1000;
-    }
+        if (VARIABLE == std::ranges::end(FORMAT_VARIABLES)) {
+            literal += in[pos++];
+            continue;
+        }
 
-    if (in.contains("$ATTEMPTS")) {
-        replaceAllAttempts(in);
-        result.allowForceUpdate = true;
-    }
+        FLUSHLITERAL();
 
-    if (in.contains("$LAYOUT")) {
-        replaceAllLayout(in);
-        result.allowForceUpdate = true;
-    }
+        SFormatToken token = {.variable = VARIABLE->second};
+        pos += VARIABLE->first.size();
 
-    if (in.contains("$FAIL")) {
-        const auto FAIL = g_pAuth->getCurrentFailText();
-        replaceInString(in, "$FAIL", FAIL);
-        result.allowForceUpdate = true;
-    }
+        // $ATTEMPTS[...] and $LAYOUT[...]
+        if ((token.variable == FORMAT_ATTEMPTS || token.variable == FORMAT_LAYOUT) && pos < in.size() && in[pos] == '[' && in.find(']', pos) != std::string::npos) {
+            const auto END = in.find(']', pos);
+            token.text     = in.substr(pos + 1, END - pos - 1);
+            token.hasArg   = true;
+            pos            = END + 1;
+        }
 
-    if (in.contains("$PAMFAIL")) {
-        const auto FAIL = g_pAuth->getFailText(AUTH_IMPL_PAM);
-        replaceInString(in, "$PAMFAIL", FAIL.value_or(""));
-        result.allowForceUpdate = true;
+        format.dependencies |= dependencyOf(token.variable);
+        format.tokens.push_back(std::move(token));
     }
 
-    if (in.contains("$PAMPROMPT")) {
-        const auto PROMPT = g_pAuth->getPrompt(AUTH_IMPL_PAM);
-        replaceInString(in, "$PAMPROMPT", PROMPT.value_or(""));
-        result.allowForceUpdate = true;
-    }
+    FLUSHLITERAL();
 
-    if (in.contains("$FPRINTFAIL")) {
-        const auto FPRINTFAIL = g_pAuth->getFailText(AUTH_IMPL_FINGERPRINT);
-        replaceInString(in, "$FPRINTFAIL", FPRINTFAIL.value_or(""));
-        result.allowForceUpdate = true;
+    auto& result = format.result;
+
+    if (format.dependencies & FORMAT_DEP_TIME) {
+        result.updateEveryMs = 1000;
+        // the time variables only show minutes, a command can change more often than that
+        result.alignToMinute = !ISCMD;
     }
 
-    if (in.contains("$FPRINTPROMPT")) {
-        const auto FPRINTPROMPT = g_pAuth->getPrompt(AUTH_IMPL_FINGERPRINT);
-        replaceInString(in, "$FPRINTPROMPT", FPRINTPROMPT.value_or(""));
+    // a timezone change force-updates clocks too
+    if (format.dependencies & (FORMAT_DEP_AUTH | FORMAT_DEP_LAYOUT | FORMAT_DEP_TIME))
         result.allowForceUpdate = true;
-    }
 
-    if (in.starts_with("cmd[") && in.contains("]")) {
-        // this is a command
-        CVarList vars(in.substr(4, in.find_first_of(']') - 4), 0, ',', true);
+    if (ISCMD) {
+        CVarList vars(cmdOptions, 0, ',', true);
 
         for (const auto& v : vars) {
             if (v.starts_with("update:")) {
@@ -254,10 +291,37 @@ IWidget::SFormatResult IWidget::formatString(std::string in) {
         }
 
         result.alwaysUpdate = true;
-        in                  = in.substr(in.find_first_of(']') + 1);
         result.cmd          = true;
     }
 
-    result.formatted = in;
+    return format;
+}
+
+IWidget::SFormatResult IWidget::formatString(const SFormatTemplate& format) {
+    SFormatResult result = format.result;
+
+    std::optional<std::chrono::hh_mm_ss<std::chrono::system_clock::duration>> time;
+
+    for (const auto& token : format.tokens) {
+        switch (token.variable) {
+            case FORMAT_LITERAL: result.formatted += token.text; break;
+            case FORMAT_DESC: result.formatted += userInfo().gecos; break;
+            case FORMAT_USER: result.formatted += userInfo().name; break;
+            case FORMAT_TIME:
+            case FORMAT_TIME12:
+                if (!time)
+                    time = g_pClock->timeOfDay();
+                result.formatted += token.variable == FORMAT_TIME12 ? getTime12h(*time) : getTime24h(*time);
+                break;
+            case FORMAT_ATTEMPTS: result.formatted += formatAttempts(token); break;
+            case FORMAT_LAYOUT: result.formatted += formatLayout(token); break;
+            case FORMAT_FAIL: result.formatted += g_pAuth->getCurrentFailText(); break;
+            case FORMAT_PAMFAIL: result.formatted += g_pAuth->getFailText(AUTH_IMPL_PAM).value_or(""); break;
+            case FORMAT_PAMPROMPT: result.formatted += g_pAuth->getPrompt(AUTH_IMPL_PAM).value_or(""); break;
+            case FORMAT_FPRINTFAIL: result.formatted += g_pAuth->getFailText(AUTH_IMPL_FINGERPRINT).value_or(""); break;
+            case FORMAT_FPRINTPROMPT: result.formatted += g_pAuth->getPrompt(AUTH_IMPL_FINGERPRINT).value_or(""); break;
+        }
+    }
+
     return result;
-}
\ No newline at end of file
+}
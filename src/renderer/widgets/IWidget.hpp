@@ -3,8 +3,10 @@
 #include "../../helpers/Math.hpp"
 #include "../../defines.hpp"
 #include "../../core/Timer.hpp"
+#include "../../helpers/AnimatedVariable.hpp"
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <any>
 
 class COutput;
@@ -25,10 +27,21 @@ class IWidget {
     virtual int getZindex() const { return m_iZindex; }
     virtual void setZindex(int zindex) { m_iZindex = zindex; }
 
+    // Damage tracking: the surface area (in pixels) the widget paints with its current state.
+    // An empty box means the widget doesn't draw anything right now.
+    virtual CBox getDamageBox() const = 0;
+    // true if the widget changed since it was last drawn
+    virtual bool isDamaged() const;
+    void damage();
+    // called by the renderer after draw(), remembers what was painted so that it can be cleared later
+    void onDrawn(bool needsFrame);
+    const CBox& getLastDamageBox() const;
+
     static Vector2D posFromHVAlign(const Vector2D& viewport, const Vector2D& size, const Vector2D& offset, const std::string& halign, const std::string& valign,
                                    const double& ang = 0);
     static int roundingForBox(const CBox& box, int roundingConfig);
     static int roundingForBorderBox(const CBox& borderBox, int roundingConfig, int thickness);
+    static CBox boundingBoxForRotation(const CBox& box);
 
     struct SFormatResult {
         std::string formatted;
@@ -36,11 +49,68 @@ class IWidget {
         bool alwaysUpdate = false;
         bool cmd = false;
         bool allowForceUpdate = false;
+        // wake on minute transitions of the wall clock instead of every updateEveryMs
+        bool alignToMinute = false;
+    };
+
+    enum eFormatVariable : uint8_t {
+        FORMAT_LITERAL = 0,
+        FORMAT_DESC,
+        FORMAT_USER,
+        FORMAT_TIME,
+        FORMAT_TIME12,
+        FORMAT_ATTEMPTS,
+        FORMAT_LAYOUT,
+        FORMAT_FAIL,
+        FORMAT_PAMFAIL,
+        FORMAT_PAMPROMPT,
+        FORMAT_FPRINTFAIL,
+        FORMAT_FPRINTPROMPT,
+    };
+
+    // what a format's text can change with, the same bits its timer is forced on
+    enum eFormatDependency : uint32_t {
+        FORMAT_DEP_NONE   = 0,
+        FORMAT_DEP_TIME   = FORCE_UPDATE_TIME,
+        FORMAT_DEP_AUTH   = FORCE_UPDATE_AUTH, // attempts, fail texts and prompts
+        FORMAT_DEP_LAYOUT = FORCE_UPDATE_LAYOUT,
+    };
+
+    struct SFormatToken {
+        eFormatVariable variable = FORMAT_LITERAL;
+        // the literal, or the [...] argument of $ATTEMPTS and $LAYOUT
+        std::string text;
+        bool hasArg = false;
     };
 
-    static SFormatResult formatString(std::string in);
+    // a format string split into literals and variables once, at configure time
+    struct SFormatTemplate {
+        std::vector<SFormatToken> tokens;
+        uint32_t dependencies = FORMAT_DEP_NONE;
+        // everything but the text is known after compiling
+        SFormatResult result;
+    };
+
+    static SFormatTemplate compileFormat(std::string in);
+    static SFormatResult formatString(const SFormatTemplate& format);
+
+    // The fade/fade_duration options. The opacity is an animated variable, so it advances once per frame with everything else.
+    struct SFadeIn {
+        bool enabled = false;
+        uint64_t durationMs = 1000;
+        PHLANIMVAR<float> opacity;
+        SP<Hyprutils::Animation::SAnimationPropertyConfig> config;
+
+        float value() const;
+    };
+
+    // animates fade.opacity from 0 to 1 if fading is enabled
+    void startFadeIn(SFadeIn& fade);
 
   protected:
     int m_iZindex = 0;
     std::shared_ptr<CTimer> m_pTimer;
+
+    bool m_bDamaged = true;
+    CBox m_lastDamageBox;
 };
\ No newline at end of file
@@ -30,30 +30,9 @@ int CImage::getZindex() const {
 void CImage::onTimer(std::shared_ptr<CTimer> timer, void* data) {
     WP<CImage> ref = *static_cast<WP<CImage>*>(data);
     if (auto PIMAGE = ref.lock(); PIMAGE) {
-        // Check if this timer is for reloading or fading
         if (timer == PIMAGE->imageTimer) {
             PIMAGE->onTimerUpdate();
             PIMAGE->plantTimer();
-        } else if (timer == PIMAGE->fade.fadeTimer) {
-            auto now = std::chrono::system_clock::now();
-            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - PIMAGE->fade.startTime).count();
-            float progress = static_cast<float>(elapsedMs) / PIMAGE->fade.durationMs;
-
-            if (progress >= 1.0f) {
-                // Fading complete
-                PIMAGE->fade.opacity = PIMAGE->fade.fadingIn ? 1.0f : 0.0f;
-                PIMAGE->fade.fadeTimer->cancel();
-                PIMAGE->fade.fadeTimer.reset();
-                PIMAGE->fade.fadingIn = !PIMAGE->fade.fadingIn; // Toggle direction for next fade
-                Debug::log(TRACE, "CImage fading complete: opacity={}", PIMAGE->fade.opacity);
-            } else {
-                // Update opacity
-                PIMAGE->fade.opacity = PIMAGE->fade.fadingIn ? progress : 1.0f - progress;
-                Debug::log(TRACE, "CImage fading: progress={}, opacity={}", progress, PIMAGE->fade.opacity);
-            }
-
-            // Trigger a render to reflect the new opacity
-            g_pMpvlock->renderOutput(PIMAGE->output->stringPort);
         }
     }
 }
@@ -94,6 +73,7 @@ void CImage::onTimerUpdate() {
     pendingResourceID = request.id;
     request.asset = path;
     request.type = CAsyncResourceGatherer::eTargetType::TARGET_IMAGE;
+    request.sizeHint = {(double)size, (double)size};
     request.callback = [REF = m_self]() { onAssetCallback(REF); };
 
     g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
@@ -102,25 +82,13 @@ void CImage::onTimerUpdate() {
 void CImage::plantTimer() {
     if (reloadTime == 0) {
         imageTimer = g_pMpvlock->addTimer(std::chrono::hours(1),
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr, true);
+                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PIMAGE = REF.lock()) PIMAGE->onTimer(timer, (void*)&REF); }, nullptr, true);
     } else if (reloadTime > 0) {
         imageTimer = g_pMpvlock->addTimer(std::chrono::seconds(reloadTime),
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr, false);
+                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PIMAGE = REF.lock()) PIMAGE->onTimer(timer, (void*)&REF); }, nullptr, false);
     }
 }
 
-void CImage::startFade() {
-    if (!fade.enabled || fade.fadeTimer) {
-        return; // Fading not enabled or already in progress
-    }
-
-    fade.startTime = std::chrono::system_clock::now();
-    fade.fadeTimer = g_pMpvlock->addTimer(std::chrono::milliseconds(16), // ~60 FPS
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); },
-                                          nullptr, false);
-    Debug::log(LOG, "CImage starting fade: fadingIn={}, duration={}ms", fade.fadingIn, fade.durationMs);
-}
-
 void CImage::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
     reset();
 
@@ -201,10 +169,7 @@ void CImage::configure(const std::unordered_map<std::string, std::any>& props, c
         plantTimer();
     }
 
-    // Start fading if enabled
-    if (fade.enabled) {
-        startFade();
-    }
+    startFadeIn(fade);
 }
 
 void CImage::reset() {
@@ -212,16 +177,12 @@ void CImage::reset() {
         imageTimer->cancel();
         imageTimer.reset();
     }
-    if (fade.fadeTimer) {
-        fade.fadeTimer->cancel();
-        fade.fadeTimer.reset();
-    }
     if (g_pMpvlock->m_bTerminate)
         return;
     imageFB.release();
     if (asset && reloadTime > -1)
         g_pRenderer->asyncResourceGatherer->unloadAsset(asset);
-    asset = nullptr;
+    asset = {};
     pendingResourceID = "";
     resourceID = "";
 }
@@ -233,8 +194,9 @@ bool CImage::draw(const SRenderData& data) {
     if (!asset)
         asset = g_pRenderer->asyncResourceGatherer->getAssetByID(resourceID);
 
+    // the gatherer repaints once the asset is uploaded
     if (!asset)
-        return true;
+        return false;
 
     if (asset->texture.m_iType == TEXTURE_INVALID) {
         g_pRenderer->asyncResourceGatherer->unloadAsset(asset);
@@ -282,7 +244,7 @@ bool CImage::draw(const SRenderData& data) {
     }
 
     SRenderData shadowData = data;
-    shadowData.opacity *= fade.opacity; // Adjust opacity for shadow
+    shadowData.opacity *= fade.value(); // Adjust opacity for shadow
     shadow.draw(shadowData); // Render shadow with adjusted opacity
 
     const auto TEXPOS = posFromHVAlign(viewport, tex->m_vSize, pos, halign, valign, angle);
@@ -291,12 +253,24 @@ bool CImage::draw(const SRenderData& data) {
 
     texbox.round();
     texbox.rot = angle;
-    float adjustedOpacity = data.opacity * fade.opacity;
+    float adjustedOpacity = data.opacity * fade.value();
     g_pRenderer->renderTexture(texbox, *tex, adjustedOpacity, 0);
 
     return adjustedOpacity < 1.0;
 }
 
+CBox CImage::getDamageBox() const {
+    if (resourceID.empty() || !imageFB.isAllocated())
+        return {};
+
+    const Vector2D SIZE = imageFB.m_cTex.m_vSize;
+    CBox           box  = {posFromHVAlign(viewport, SIZE, pos, halign, valign, angle), SIZE};
+    box.round();
+    box.rot = angle;
+
+    return shadow.damageFor(boundingBoxForRotation(box));
+}
+
 void CImage::renderUpdate() {
     auto newAsset = g_pRenderer->asyncResourceGatherer->getAssetByID(pendingResourceID);
     if (newAsset) {
@@ -308,6 +282,7 @@ void CImage::renderUpdate() {
             asset = newAsset;
             resourceID = pendingResourceID;
             firstRender = true;
+            damage();
         }
         pendingResourceID = "";
     } else if (!pendingResourceID.empty()) {
@@ -12,7 +12,6 @@
 #include <unordered_map>
 #include <any>
 
-struct SPreloadedAsset;
 class COutput;
 
 class CImage : public IWidget {
@@ -28,12 +27,12 @@ class CImage : public IWidget {
     virtual void setZindex(int zindex) override;
     virtual int getZindex() const override;
     virtual void onTimer(std::shared_ptr<CTimer> timer, void* data) override;
+    virtual CBox getDamageBox() const override;
 
     void reset();
     void renderUpdate();
     void onTimerUpdate();
     void plantTimer();
-    void startFade();
 
   private:
     WP<CImage> m_self;
@@ -56,19 +55,11 @@ class CImage : public IWidget {
     Vector2D viewport;
     std::string resourceID;
     std::string pendingResourceID; // if reloading image
-    SPreloadedAsset* asset = nullptr;
+    SAssetHandle asset;
     COutput* output = nullptr;
     CShadowable shadow;
 
     int zindex = 20; // Default: above shape, below input-field
 
-    // Fading functionality
-    struct {
-        float opacity = 1.0f;
-        bool enabled = false;
-        bool fadingIn = true;
-        uint64_t durationMs = 1000;
-        std::shared_ptr<CTimer> fadeTimer = nullptr;
-        std::chrono::system_clock::time_point startTime;
-    } fade;
+    SFadeIn fade;
 };
\ No newline at end of file
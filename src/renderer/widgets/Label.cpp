@@ -2,6 +2,7 @@
 #include "../Renderer.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../core/mpvlock.hpp"
+#include "../../core/Clock.hpp"
 #include "../../auth/Auth.hpp"
 #include "../../helpers/Color.hpp"
 #include "../../config/ConfigDataValues.hpp"
@@ -32,30 +33,9 @@ int CLabel::getZindex() const {
 void CLabel::onTimer(std::shared_ptr<CTimer> timer, void* data) {
     WP<CLabel> ref = *static_cast<WP<CLabel>*>(data);
     if (auto PLABEL = ref.lock(); PLABEL) {
-        // Check if this timer is for label updates or fading
         if (timer == PLABEL->labelTimer) {
             PLABEL->onTimerUpdate();
             PLABEL->plantTimer();
-        } else if (timer == PLABEL->fade.fadeTimer) {
-            auto now = std::chrono::system_clock::now();
-            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - PLABEL->fade.startTime).count();
-            float progress = static_cast<float>(elapsedMs) / PLABEL->fade.durationMs;
-
-            if (progress >= 1.0f) {
-                // Fading complete
-                PLABEL->fade.opacity = PLABEL->fade.fadingIn ? 1.0f : 0.0f;
-                PLABEL->fade.fadeTimer->cancel();
-                PLABEL->fade.fadeTimer.reset();
-                PLABEL->fade.fadingIn = !PLABEL->fade.fadingIn; // Toggle direction for next fade
-                // Debug::log(TRACE, "CLabel fading complete: opacity={}", PLABEL->fade.opacity);
-            } else {
-                // Update opacity
-                PLABEL->fade.opacity = PLABEL->fade.fadingIn ? progress : 1.0f - progress;
-                // Debug::log(TRACE, "CLabel fading: progress={}, opacity={}", progress, PLABEL->fade.opacity);
-            }
-
-            // Trigger a render to reflect the new opacity
-            g_pMpvlock->renderOutput(PLABEL->outputStringPort);
         }
     }
 }
@@ -69,20 +49,40 @@ std::string CLabel::getUniqueResourceId() {
     return std::string{"label:"} + std::to_string((uintptr_t)this) + ",time:" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
 }
 
+bool CLabel::layoutGlyphs() {
+    glyphParams.text = label.formatted;
+    if (g_pRenderer->glyphAtlas->layout(glyphParams, glyphs, &glyphLines))
+        return true;
+
+    Debug::log(LOG, "Label {} can't be drawn from the glyph atlas, rasterizing it instead", label.formatted);
+    useGlyphs = false;
+    return false;
+}
+
+Vector2D CLabel::contentSize() const {
+    // the old mesh stays up until a rasterized fallback arrives
+    return asset ? asset->texture.m_vSize : glyphs.size;
+}
+
 void CLabel::onTimerUpdate() {
     std::string oldFormatted = label.formatted;
 
     // Check auth state explicitly for $FAIL or $PAMPROMPT
-    bool authWaiting = g_pAuth->checkWaiting();
-    auto failText = g_pAuth->getCurrentFailText();
-    bool authChanged = authWaiting || !failText.empty();
+    bool authChanged = (labelFormat.dependencies & FORMAT_DEP_AUTH) && (g_pAuth->checkWaiting() || !g_pAuth->getCurrentFailText().empty());
 
-    label = formatString(labelPreFormat);
+    label = formatString(labelFormat);
 
     // Update only if text changed or auth state requires it
     if (label.formatted == oldFormatted && !label.alwaysUpdate && !authChanged)
         return;
 
+    if (useGlyphs && layoutGlyphs()) {
+        updateShadow = true;
+        damage();
+        g_pMpvlock->renderOutput(outputStringPort);
+        return;
+    }
+
     if (!pendingResourceID.empty()) {
         Debug::log(WARN, "Trying to update label, but resource {} is still pending! Skipping update.", pendingResourceID);
         return;
@@ -98,26 +98,21 @@ void CLabel::onTimerUpdate() {
 }
 
 void CLabel::plantTimer() {
-    if (label.updateEveryMs != 0)
+    // forced only by changes to what it shows, a command can show anything
+    const uint32_t FORCEREASONS = label.cmd ? FORCE_UPDATE_ALL : labelFormat.dependencies;
+
+    if (label.alignToMinute)
+        labelTimer = g_pMpvlock->addTimer(g_pClock->untilNextMinute(), 
+                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PLABEL = REF.lock()) PLABEL->onTimer(timer, (void*)&REF); }, 
+                                          nullptr, label.allowForceUpdate, FORCEREASONS);
+    else if (label.updateEveryMs != 0)
         labelTimer = g_pMpvlock->addTimer(std::chrono::milliseconds((int)label.updateEveryMs), 
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, 
-                                          nullptr, label.allowForceUpdate);
+                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PLABEL = REF.lock()) PLABEL->onTimer(timer, (void*)&REF); }, 
+                                          nullptr, label.allowForceUpdate, FORCEREASONS);
     else if (label.updateEveryMs == 0 && label.allowForceUpdate)
         labelTimer = g_pMpvlock->addTimer(std::chrono::hours(1), 
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, 
-                                          nullptr, true);
-}
-
-void CLabel::startFade() {
-    if (!fade.enabled || fade.fadeTimer) {
-        return; // Fading not enabled or already in progress
-    }
-
-    fade.startTime = std::chrono::system_clock::now();
-    fade.fadeTimer = g_pMpvlock->addTimer(std::chrono::milliseconds(16), // ~60 FPS
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); },
-                                          nullptr, false);
-    // Debug::log(LOG, "CLabel starting fade: fadingIn={}, duration={}ms", fade.fadingIn, fade.durationMs);
+                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PLABEL = REF.lock()) PLABEL->onTimer(timer, (void*)&REF); }, 
+                                          nullptr, true, FORCEREASONS);
 }
 
 void CLabel::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
@@ -136,7 +131,7 @@ void CLabel::configure(const std::unordered_map<std::string, std::any>& props, c
 
         configPos      = CLayoutValueData::fromAnyPv(props.at("position"))->getAbsolute(viewport);
         // Debug::log(LOG, "Parsed label position: {}x{}", configPos.x, configPos.y);
-        labelPreFormat = std::any_cast<Hyprlang::STRING>(props.at("text"));
+        labelFormat    = compileFormat(std::any_cast<Hyprlang::STRING>(props.at("text")));
         halign         = std::any_cast<Hyprlang::STRING>(props.at("halign"));
         valign         = std::any_cast<Hyprlang::STRING>(props.at("valign"));
         angle          = std::any_cast<Hyprlang::FLOAT>(props.at("rotate"));
@@ -205,7 +200,7 @@ void CLabel::configure(const std::unordered_map<std::string, std::any>& props, c
             }
         }
 
-        label = formatString(labelPreFormat);
+        label = formatString(labelFormat);
 
         request.id                   = getUniqueResourceId();
         resourceID                   = request.id;
@@ -227,6 +222,12 @@ void CLabel::configure(const std::unordered_map<std::string, std::any>& props, c
         if (!textAlign.empty())
             request.props["text_align"] = textAlign;
 
+        useGlyphs              = !label.cmd && textOrientation != "vertical";
+        glyphParams.fontFamily = fontFamily;
+        glyphParams.fontSize   = fontSize;
+        glyphParams.color      = labelColor;
+        glyphParams.textAlign  = textAlign;
+
     } catch (const std::bad_any_cast& e) {
         RASSERT(false, "Failed to construct CLabel: {}", e.what());
     } catch (const std::out_of_range& e) {
@@ -235,14 +236,12 @@ void CLabel::configure(const std::unordered_map<std::string, std::any>& props, c
 
     pos = configPos;
 
-    g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
+    if (!useGlyphs || !layoutGlyphs())
+        g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
 
     plantTimer();
 
-    // Start fading if enabled
-    if (fade.enabled) {
-        startFade();
-    }
+    startFadeIn(fade);
 }
 
 void CLabel::reset() {
@@ -251,28 +250,26 @@ void CLabel::reset() {
         labelTimer.reset();
     }
 
-    if (fade.fadeTimer) {
-        fade.fadeTimer->cancel();
-        fade.fadeTimer.reset();
-    }
-
     if (g_pMpvlock->m_bTerminate)
         return;
 
     if (asset)
         g_pRenderer->asyncResourceGatherer->unloadAsset(asset);
 
-    asset = nullptr;
+    asset      = {};
+    glyphs     = {};
+    glyphLines = {};
     pendingResourceID.clear();
     resourceID.clear();
 }
 
 bool CLabel::draw(const SRenderData& data) {
-    if (!asset) {
+    if (!asset && !useGlyphs) {
         asset = g_pRenderer->asyncResourceGatherer->getAssetByID(resourceID);
-        if (!asset) {
-            Debug::log(WARN, "No asset for label, resourceID: {}", resourceID);
-            return true;
+        if (!asset && glyphs.batches.empty()) {
+            // the gatherer repaints once the asset is uploaded
+            Debug::log(TRACE, "No asset for label yet, resourceID: {}", resourceID);
+            return false;
         }
     }
 
@@ -282,10 +279,10 @@ bool CLabel::draw(const SRenderData& data) {
     }
 
     SRenderData shadowData = data;
-    shadowData.opacity *= fade.opacity; // Adjust opacity for shadow
+    shadowData.opacity *= fade.value(); // Adjust opacity for shadow
     shadow.draw(shadowData);
 
-    Vector2D size = asset->texture.m_vSize;
+    Vector2D size = contentSize();
     if (size.x <= 0 || size.y <= 0) {
         Debug::log(WARN, "Invalid texture size {}x{} for label: {}, skipping render", size.x, size.y, label.formatted);
         return true;
@@ -306,22 +303,40 @@ bool CLabel::draw(const SRenderData& data) {
     CBox box = {adjustedPos.x, adjustedPos.y, size.x, size.y};
     box.rot = finalAngle;
 
-    float adjustedOpacity = data.opacity * fade.opacity;
-    g_pRenderer->renderTexture(box, asset->texture, adjustedOpacity);
+    float adjustedOpacity = data.opacity * fade.value();
+    if (asset)
+        g_pRenderer->renderTexture(box, asset->texture, adjustedOpacity);
+    else
+        g_pRenderer->renderGlyphs(box, glyphs, adjustedOpacity);
 
     // Debug::log(TRACE, "Drawing label at {}x{} with size: {}x{}, text: {}, orientation: {}", 
     //            box.x, box.y, box.w, box.h, label.formatted, textOrientation);
     return adjustedOpacity < 1.0;
 }
 
+CBox CLabel::getDamageBox() const {
+    if (!asset && glyphs.size.x <= 0)
+        return {};
+
+    const Vector2D SIZE = contentSize();
+    const double   ANG  = textOrientation == "vertical" ? angle + M_PI / 2.0 : angle;
+
+    CBox           box = {posFromHVAlign(viewport, SIZE, configPos, halign, valign, ANG), SIZE};
+    box.rot            = ANG;
+
+    return shadow.damageFor(boundingBoxForRotation(box));
+}
+
 void CLabel::renderUpdate() {
     auto newAsset = g_pRenderer->asyncResourceGatherer->getAssetByID(pendingResourceID);
     if (newAsset) {
         g_pRenderer->asyncResourceGatherer->unloadAsset(asset);
         asset             = newAsset;
+        glyphs            = {};
         resourceID        = pendingResourceID;
         pendingResourceID = "";
         updateShadow      = true;
+        damage();
     } else {
         Debug::log(WARN, "Asset {} not available after the asyncResourceGatherer’s callback!", pendingResourceID);
         g_pMpvlock->addTimer(std::chrono::milliseconds(100), [REF = m_self](auto, auto) { onAssetCallback(REF); }, nullptr);
@@ -5,11 +5,11 @@
 #include "../../helpers/Math.hpp"
 #include "../../core/Timer.hpp"
 #include "../AsyncResourceGatherer.hpp"
+#include "../GlyphAtlas.hpp"
 #include <string>
 #include <unordered_map>
 #include <any>
 
-struct SPreloadedAsset;
 class CSessionLockSurface;
 
 class CLabel : public IWidget {
@@ -25,6 +25,7 @@ class CLabel : public IWidget {
     virtual void setZindex(int zindex) override;
     virtual int getZindex() const override;
     virtual void onTimer(std::shared_ptr<CTimer> timer, void* data) override;
+    virtual CBox getDamageBox() const override;
 
     void reset();
     void renderUpdate();
@@ -36,8 +37,10 @@ class CLabel : public IWidget {
     WP<CLabel> m_self;
 
     std::string getUniqueResourceId();
+    bool        layoutGlyphs();
+    Vector2D    contentSize() const;
 
-    std::string labelPreFormat;
+    IWidget::SFormatTemplate labelFormat;
     IWidget::SFormatResult label;
 
     Vector2D viewport;
@@ -48,24 +51,20 @@ class CLabel : public IWidget {
     std::string pendingResourceID; // if dynamic label
     std::string halign, valign;
     std::string textOrientation = "horizontal"; // Added for vertical text support
-    SPreloadedAsset* asset = nullptr;
+    SAssetHandle asset;
     std::string outputStringPort;
 
     CAsyncResourceGatherer::SPreloadRequest request;
+
+    // plain labels are drawn from the glyph atlas, cmd and vertical ones still go through the gatherer
+    bool useGlyphs = false;
+    CGlyphAtlas::SLayoutParams glyphParams;
+    CGlyphAtlas::SMesh glyphs;
+    CGlyphAtlas::SLineCache glyphLines;
     std::shared_ptr<CTimer> labelTimer = nullptr;
 
     CShadowable shadow;
     bool updateShadow = true;
 
-    // Fading functionality
-    struct {
-        float opacity = 1.0f;
-        bool enabled = false;
-        bool fadingIn = true;
-        uint64_t durationMs = 1000;
-        std::shared_ptr<CTimer> fadeTimer = nullptr;
-        std::chrono::system_clock::time_point startTime;
-    } fade;
-
-    void startFade();
+    SFadeIn fade;
 };
\ No newline at end of file
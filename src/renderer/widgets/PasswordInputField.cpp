@@ -42,6 +42,33 @@ void CPasswordInputField::onTimer(std::shared_ptr<CTimer> timer, void* data) {
     }
 }
 
+CBox CPasswordInputField::getDamageBox() const {
+    const auto POS = posFromHVAlign(viewport, size->value(), configPos, halign, valign);
+    CBox       box = {POS - Vector2D{outThick, outThick}, size->value() + Vector2D{outThick * 2, outThick * 2}};
+
+    return shadow.damageFor(box.round());
+}
+
+bool CPasswordInputField::isDamaged() const {
+    if (IWidget::isDamaged())
+        return true;
+
+    if (passwordLength != g_pMpvlock->getPasswordBufferDisplayLen() || checkWaiting != g_pAuth->checkWaiting())
+        return true;
+
+    if (drawnState.capsLock != g_pMpvlock->m_bCapsLock || drawnState.numLock != g_pMpvlock->m_bNumLock || drawnState.displayFailText != g_pAuth->m_bDisplayFailText ||
+        drawnState.failedAttempts != g_pAuth->getFailedAttempts())
+        return true;
+
+    // prompts, the layout and the time can change what the placeholder says without touching anything above
+    const auto& FORMAT = displayFail ? failFormat : placeholderFormat;
+    if (passwordLength == 0 && (FORMAT.dependencies & (FORMAT_DEP_TIME | FORMAT_DEP_AUTH | FORMAT_DEP_LAYOUT)) && formatString(FORMAT).formatted != placeholder.currentText)
+        return true;
+
+    return fade.a->isBeingAnimated() || size->isBeingAnimated() || dots.currentAmount->isBeingAnimated() || colorState.inner->isBeingAnimated() ||
+        colorState.outer->isBeingAnimated();
+}
+
 void CPasswordInputField::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
     reset();
 
@@ -67,6 +94,8 @@ void CPasswordInputField::configure(const std::unordered_map<std::string, std::a
         rounding                 = std::any_cast<Hyprlang::INT>(props.at("rounding"));
         configPlaceholderText    = std::any_cast<Hyprlang::STRING>(props.at("placeholder_text"));
         configFailText           = std::any_cast<Hyprlang::STRING>(props.at("fail_text"));
+        placeholderFormat        = compileFormat(configPlaceholderText);
+        failFormat               = compileFormat(configFailText);
         fontFamily               = std::any_cast<Hyprlang::STRING>(props.at("font_family"));
         colorConfig.outer        = CGradientValueData::fromAnyPv(props.at("outer_color"));
         colorConfig.inner        = std::any_cast<Hyprlang::INT>(props.at("inner_color"));
@@ -143,11 +172,11 @@ void CPasswordInputField::reset() {
     if (placeholder.asset)
         g_pRenderer->asyncResourceGatherer->unloadAsset(placeholder.asset);
 
-    placeholder.asset = nullptr;
+    placeholder.asset = {};
     placeholder.resourceID.clear();
     placeholder.currentText.clear();
     placeholder.registeredResourceIDs.clear();
-    dots.textAsset = nullptr;
+    dots.textAsset = {};
     dots.textResourceID.clear();
     firstRender = true;
     redrawShadow = false;
@@ -155,6 +184,8 @@ void CPasswordInputField::reset() {
     displayFail = false;
     m_bDisplayFailText = false;
     passwordLength = 0;
+    drawnState = {};
+    damage();
 }
 
 bool CPasswordInputField::draw(const SRenderData& data) {
@@ -177,6 +208,11 @@ bool CPasswordInputField::draw(const SRenderData& data) {
     updateWidth();
     updateHiddenInputState();
 
+    drawnState.capsLock        = g_pMpvlock->m_bCapsLock;
+    drawnState.numLock         = g_pMpvlock->m_bNumLock;
+    drawnState.displayFailText = g_pAuth->m_bDisplayFailText;
+    drawnState.failedAttempts  = g_pAuth->getFailedAttempts();
+
     CBox inputFieldBox = {pos, size->value()};
     CBox outerBox      = {pos - Vector2D{outThick, outThick}, size->value() + Vector2D{outThick * 2, outThick * 2}};
 
@@ -203,11 +239,9 @@ bool CPasswordInputField::draw(const SRenderData& data) {
                 outerBoxScaled.y += outerBoxScaled.h;
             if (hiddenInputState.lastQuadrant % 2 == 1)
                 outerBoxScaled.x += outerBoxScaled.w;
-            glEnable(GL_SCISSOR_TEST);
-            glScissor(outerBoxScaled.x, outerBoxScaled.y, outerBoxScaled.w, outerBoxScaled.h);
+            g_pRenderer->scissor(outerBoxScaled);
             g_pRenderer->renderBorder(outerBox, hiddenInputState.lastColor, outThick, OUTERROUND, fade.a->value() * data.opacity);
-            glScissor(0, 0, viewport.x, viewport.y);
-            glDisable(GL_SCISSOR_TEST);
+            g_pRenderer->unscissor();
         }
     }
 
@@ -279,7 +313,7 @@ bool CPasswordInputField::draw(const SRenderData& data) {
     }
 
     if (passwordLength == 0 && !checkWaiting && !placeholder.resourceID.empty()) {
-        SPreloadedAsset* currAsset = nullptr;
+        SAssetHandle currAsset;
 
         if (!placeholder.asset)
             placeholder.asset = g_pRenderer->asyncResourceGatherer->getAssetByID(placeholder.resourceID);
@@ -290,11 +324,9 @@ bool CPasswordInputField::draw(const SRenderData& data) {
             const Vector2D ASSETPOS = inputFieldBox.pos() + inputFieldBox.size() / 2.0 - currAsset->texture.m_vSize / 2.0;
             const CBox ASSETBOX{ASSETPOS, currAsset->texture.m_vSize};
 
-            glEnable(GL_SCISSOR_TEST);
-            glScissor(inputFieldBox.x, inputFieldBox.y, inputFieldBox.w, inputFieldBox.h);
+            g_pRenderer->scissor(inputFieldBox);
             g_pRenderer->renderTexture(ASSETBOX, currAsset->texture, data.opacity * fade.a->value(), 0);
-            glScissor(0, 0, viewport.x, viewport.y);
-            glDisable(GL_SCISSOR_TEST);
+            g_pRenderer->unscissor();
         } else
             forceReload = true;
     }
@@ -307,19 +339,14 @@ void CPasswordInputField::updatePlaceholder() {
         if (placeholder.asset && displayFail) {
             std::erase(placeholder.registeredResourceIDs, placeholder.resourceID);
             g_pRenderer->asyncResourceGatherer->unloadAsset(placeholder.asset);
-            placeholder.asset     = nullptr;
+            placeholder.asset     = {};
             placeholder.resourceID = "";
             redrawShadow          = true;
         }
         return;
     }
 
-    if (displayFail && placeholder.failedAttempts == g_pAuth->getFailedAttempts())
-        return;
-
-    placeholder.failedAttempts = g_pAuth->getFailedAttempts();
-
-    std::string newText = (displayFail && !configFailText.empty()) ? formatString(configFailText).formatted : formatString(configPlaceholderText).formatted;
+    std::string newText = (displayFail && !configFailText.empty()) ? formatString(failFormat).formatted : formatString(placeholderFormat).formatted;
 
     const auto ALLOWCOLORSWAP = outThick == 0 && colorConfig.swapFont;
     if (!ALLOWCOLORSWAP && newText == placeholder.currentText)
@@ -333,7 +360,7 @@ void CPasswordInputField::updatePlaceholder() {
 
     Debug::log(TRACE, "Updating placeholder text: {}", newText);
     placeholder.currentText = newText;
-    placeholder.asset       = nullptr;
+    placeholder.asset       = {};
     placeholder.resourceID  = NEWRESOURCEID;
 
     if (std::ranges::find(placeholder.registeredResourceIDs, placeholder.resourceID) != placeholder.registeredResourceIDs.end())
@@ -350,8 +377,10 @@ void CPasswordInputField::updatePlaceholder() {
     request.props["color"]       = colorState.font;
     request.props["font_size"]   = (int)size->value().y / 4;
     request.callback             = [REF = m_self] {
-        if (const auto SELF = REF.lock(); SELF)
+        if (const auto SELF = REF.lock(); SELF) {
+            SELF->damage();
             g_pMpvlock->renderOutput(SELF->outputStringPort);
+        }
     };
     g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
 }
@@ -475,7 +504,7 @@ void CPasswordInputField::updateFade() {
 
     if (m_bDisplayFailText && !checkWaiting && !fade.fadeOutTimer.get()) {
         fade.fadeOutTimer = g_pMpvlock->addTimer(std::chrono::milliseconds(fadeTimeoutMs),
-                                                 [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr);
+                                                 [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PINPUTFIELD = REF.lock()) PINPUTFIELD->onTimer(timer, (void*)&REF); }, nullptr);
         fade.allowFadeOut = true;
     } else if (!INPUTUSED && fade.a->goal() != 0.0) {
         if (fade.allowFadeOut || fadeTimeoutMs == 0) {
@@ -483,7 +512,7 @@ void CPasswordInputField::updateFade() {
             fade.allowFadeOut = false;
         } else if (!fade.fadeOutTimer.get()) {
             fade.fadeOutTimer = g_pMpvlock->addTimer(std::chrono::milliseconds(fadeTimeoutMs),
-                                                     [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); }, nullptr);
+                                                     [REF = m_self](std::shared_ptr<CTimer> timer, void*) { if (auto PINPUTFIELD = REF.lock()) PINPUTFIELD->onTimer(timer, (void*)&REF); }, nullptr);
         }
     } else if (INPUTUSED && fade.a->goal() != 1.0) {
         *fade.a = 1.0;
@@ -502,6 +531,7 @@ void CPasswordInputField::onFadeOutTimer() {
     *fade.a            = 1.0;
 
     Debug::log(TRACE, "PasswordInputField: Fade out complete, clearing failure text");
+    damage();
     g_pMpvlock->renderOutput(outputStringPort);
 
     fade.fadeOutTimer.reset();
@@ -7,13 +7,12 @@
 #include "Shadowable.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include "../../helpers/AnimatedVariable.hpp"
+#include "../Shared.hpp"
 #include <hyprutils/math/Vector2D.hpp>
 #include <vector>
 #include <any>
 #include <unordered_map>
 
-struct SPreloadedAsset;
-
 class CPasswordInputField : public IWidget {
   public:
     CPasswordInputField() = default;
@@ -27,6 +26,8 @@ class CPasswordInputField : public IWidget {
     virtual void setZindex(int zindex) override;
     virtual int getZindex() const override;
     virtual void onTimer(std::shared_ptr<CTimer> timer, void* data) override; // Add this declaration
+    virtual CBox getDamageBox() const override;
+    virtual bool isDamaged() const override;
 
     void reset();
     void onFadeOutTimer();
@@ -51,6 +52,14 @@ class CPasswordInputField : public IWidget {
 
     size_t passwordLength = 0;
 
+    // global state the field was last drawn with, see isDamaged()
+    struct {
+        bool capsLock = false;
+        bool numLock = false;
+        bool displayFailText = false;
+        size_t failedAttempts = 0;
+    } drawnState;
+
     PHLANIMVAR<Vector2D> size;
     Vector2D pos;
     Vector2D viewport;
@@ -58,6 +67,7 @@ class CPasswordInputField : public IWidget {
     Vector2D configSize;
 
     std::string halign, valign, configFailText, outputStringPort, configPlaceholderText, fontFamily;
+    SFormatTemplate placeholderFormat, failFormat;
     uint64_t configFailTimeoutMs = 2000;
 
     int outThick, rounding;
@@ -70,7 +80,7 @@ class CPasswordInputField : public IWidget {
         int rounding = 0;
         std::string textFormat = "";
         std::string textResourceID;
-        SPreloadedAsset* textAsset = nullptr;
+        SAssetHandle textAsset;
     } dots;
 
     struct {
@@ -82,9 +92,8 @@ class CPasswordInputField : public IWidget {
 
     struct {
         std::string resourceID = "";
-        SPreloadedAsset* asset = nullptr;
+        SAssetHandle asset;
         std::string currentText = "";
-        size_t failedAttempts = 0;
         std::vector<std::string> registeredResourceIDs;
     } placeholder;
 
@@ -1,6 +1,8 @@
 #include "Shadowable.hpp"
 #include "../Renderer.hpp"
 #include <hyprlang.hpp>
+#include <algorithm>
+#include <cmath>
 
 void CShadowable::configure(WP<IWidget> widget_, const std::unordered_map<std::string, std::any>& props, const Vector2D& viewport_) {
     m_widget = widget_;
@@ -10,6 +12,7 @@ void CShadowable::configure(WP<IWidget> widget_, const std::unordered_map<std::s
     passes = std::any_cast<Hyprlang::INT>(props.at("shadow_passes"));
     color  = std::any_cast<Hyprlang::INT>(props.at("shadow_color"));
     boostA = std::any_cast<Hyprlang::FLOAT>(props.at("shadow_boost"));
+    scale  = std::clamp(std::any_cast<Hyprlang::FLOAT>(props.at("shadow_blur_scale")), 0.05f, 1.f);
 }
 
 void CShadowable::markShadowDirty() {
@@ -32,7 +35,7 @@ void CShadowable::markShadowDirty() {
     WIDGET->draw(IWidget::SRenderData{.opacity = 1.0});
     ignoreDraw = false;
 
-    g_pRenderer->blurFB(shadowFB, CRenderer::SBlurParams{.size = size, .passes = passes, .colorize = color, .boostA = boostA});
+    g_pRenderer->blurFB(shadowFB, CRenderer::SBlurParams{.size = size, .passes = passes, .colorize = color, .boostA = boostA, .scale = scale});
 
     g_pRenderer->popFb();
 }
@@ -48,3 +51,12 @@ bool CShadowable::draw(const IWidget::SRenderData& data) {
     g_pRenderer->renderTexture(box, shadowFB.m_cTex, data.opacity, 0, HYPRUTILS_TRANSFORM_NORMAL);
     return true;
 }
+
+CBox CShadowable::damageFor(const CBox& box) const {
+    if (!m_widget || passes == 0 || box.empty())
+        return box;
+
+    // every blur pass doubles the sample distance, same estimate as the compositor uses. a lower working resolution stretches it further.
+    const double RADIUS = std::clamp(size, 1, 40) * std::pow(2, std::min(passes, 10)) / scale;
+    return box.copy().expand(RADIUS).intersection({0, 0, viewport.x, viewport.y});
+}
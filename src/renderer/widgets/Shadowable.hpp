@@ -19,11 +19,15 @@ class CShadowable {
     void         markShadowDirty();
     virtual bool draw(const IWidget::SRenderData& data);
 
+    // grows the widget's box by the reach of the blurred shadow
+    CBox         damageFor(const CBox& box) const;
+
   private:
     WP<IWidget> m_widget;
     int         size   = 10;
     int         passes = 4;
     float       boostA = 1.0;
+    float       scale  = 1.0;
     CHyprColor  color{0, 0, 0, 1.0};
     Vector2D    viewport;
 
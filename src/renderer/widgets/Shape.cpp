@@ -5,6 +5,7 @@
 #include "../../core/mpvlock.hpp"
 #include <hyprlang.hpp>
 #include <GLES3/gl32.h>
+#include <algorithm>
 #include <cmath>
 #include <optional>
 
@@ -25,45 +26,7 @@ int CShape::getZindex() const {
 }
 
 void CShape::onTimer(std::shared_ptr<CTimer> timer, void* data) {
-    WP<CShape> ref = *static_cast<WP<CShape>*>(data);
-    if (auto PSHAPE = ref.lock(); PSHAPE) {
-        if (!PSHAPE->fade.enabled) {
-            Debug::log(TRACE, "CShape::onTimer called, but fading is not enabled.");
-            return;
-        }
-
-        auto now = std::chrono::system_clock::now();
-        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - PSHAPE->fade.startTime).count();
-        float progress = static_cast<float>(elapsedMs) / PSHAPE->fade.durationMs;
-
-        if (progress >= 1.0f) {
-            // Fading complete
-            PSHAPE->fade.opacity = PSHAPE->fade.fadingIn ? 1.0f : 0.0f;
-            PSHAPE->fade.fadeTimer->cancel();
-            PSHAPE->fade.fadeTimer.reset();
-            PSHAPE->fade.fadingIn = !PSHAPE->fade.fadingIn; // Toggle direction for next fade
-            Debug::log(TRACE, "CShape fading complete: opacity={}", PSHAPE->fade.opacity);
-        } else {
-            // Update opacity
-            PSHAPE->fade.opacity = PSHAPE->fade.fadingIn ? progress : 1.0f - progress;
-            Debug::log(TRACE, "CShape fading: progress={}, opacity={}", progress, PSHAPE->fade.opacity);
-        }
-
-        // Trigger a render to reflect the new opacity
-        g_pMpvlock->renderOutput(PSHAPE->outputPort);
-    }
-}
-
-void CShape::startFade() {
-    if (!fade.enabled || fade.fadeTimer) {
-        return; // Fading not enabled or already in progress
-    }
-
-    fade.startTime = std::chrono::system_clock::now();
-    fade.fadeTimer = g_pMpvlock->addTimer(std::chrono::milliseconds(16), // ~60 FPS
-                                          [REF = m_self](std::shared_ptr<CTimer> timer, void*) { REF.lock()->onTimer(timer, (void*)&REF); },
-                                          nullptr, false);
-    Debug::log(LOG, "CShape starting fade: fadingIn={}, duration={}ms", fade.fadingIn, fade.durationMs);
+    // no timers, the fade is ticked by the animation manager
 }
 
 void CShape::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
@@ -236,6 +199,15 @@ void CShape::configure(const std::unordered_map<std::string, std::any>& props, c
             }
         }
 
+        if (props.contains("blur_scale")) {
+            auto val = props.at("blur_scale");
+            if (val.type() == typeid(Hyprlang::FLOAT)) {
+                blurParams.scale = std::clamp(std::any_cast<Hyprlang::FLOAT>(val), 0.05f, 1.f);
+            } else {
+                Debug::log(WARN, "Shape blur_scale has unexpected type, defaulting to 1.0");
+            }
+        }
+
         // Parse zindex
         if (props.contains("zindex")) {
             auto val = props.at("zindex");
@@ -357,10 +329,7 @@ void CShape::configure(const std::unordered_map<std::string, std::any>& props, c
             Debug::log(LOG, "Skipped posFromHVAlign, using raw position: {}x{}", pos.x, pos.y);
         }
 
-        // Start fading if enabled
-        if (fade.enabled) {
-            startFade();
-        }
+        startFadeIn(fade);
 
         // Log final state
         Debug::log(LOG, "Shape configured: pos={}x{}, size={}x{}, zindex={}, fade_enabled={}", pos.x, pos.y, size.x, size.y, getZindex(), fade.enabled);
@@ -379,6 +348,14 @@ void CShape::configure(const std::unordered_map<std::string, std::any>& props, c
     }
 }
 
+CBox CShape::getDamageBox() const {
+    CBox box = {pos.x - border, pos.y - border, size.x + border * 2, size.y + border * 2};
+    box.round();
+    box.rot = angle;
+
+    return boundingBoxForRotation(box);
+}
+
 bool CShape::draw(const SRenderData& data) {
     try {
         CBox box = {pos.x, pos.y, size.x, size.y};
@@ -386,15 +363,16 @@ bool CShape::draw(const SRenderData& data) {
         box.rot = angle;
 
         Debug::log(LOG, "Drawing shape at {}x{} with size: {}x{}, color: r={}, g={}, b={}, a={}, zindex={}, opacity={}",
-                   box.x, box.y, box.w, box.h, color.r, color.g, color.b, color.a, getZindex(), fade.opacity);
+                   box.x, box.y, box.w, box.h, color.r, color.g, color.b, color.a, getZindex(), fade.value());
 
-        float adjustedOpacity = data.opacity * fade.opacity;
+        float adjustedOpacity = data.opacity * fade.value();
 
         if (blurEnabled) {
             if (!shapeFB.isAllocated()) {
                 shapeFB.alloc((int)(size.x + border * 2), (int)(size.y + border * 2), true);
             }
 
+            g_pRenderer->pushFb(shapeFB.m_iFb);
             shapeFB.bind();
             glClearColor(0.0, 0.0, 0.0, 0.0);
             glClear(GL_COLOR_BUFFER_BIT);
@@ -418,9 +396,10 @@ bool CShape::draw(const SRenderData& data) {
             CRenderer::SBlurParams rendererBlurParams = {
                 .size = blurParams.size,
                 .passes = blurParams.passes,
+                .scale = blurParams.scale,
             };
             g_pRenderer->blurFB(shapeFB, rendererBlurParams);
-            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            g_pRenderer->popFb();
 
             CBox texBox = {pos.x - border, pos.y - border, size.x + border * 2, size.y + border * 2};
             texBox.round();
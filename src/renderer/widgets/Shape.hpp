@@ -22,6 +22,7 @@ class CShape : public IWidget {
     virtual void setZindex(int zindex) override;
     virtual int getZindex() const override;
     virtual void onTimer(std::shared_ptr<CTimer> timer, void* data) override;
+    virtual CBox getDamageBox() const override;
 
   private:
     WP<CShape> m_self;
@@ -33,6 +34,7 @@ class CShape : public IWidget {
     struct {
         int size = 0;
         int passes = 0;
+        float scale = 1.0;
     } blurParams;
     int zindex = 10; // Default: above background, below input-field
 
@@ -48,17 +50,7 @@ class CShape : public IWidget {
     Vector2D viewport;
     CShadowable shadow;
 
-    // Fading functionality
-    struct {
-        float opacity = 1.0f;
-        bool enabled = false;
-        bool fadingIn = true;
-        uint64_t durationMs = 1000;
-        std::shared_ptr<CTimer> fadeTimer = nullptr;
-        std::chrono::system_clock::time_point startTime;
-    } fade;
+    SFadeIn fade;
 
     std::string outputPort; // Added for renderOutput
-
-    void startFade();
 };
\ No newline at end of file